@@ -0,0 +1,76 @@
+//===-- ConstraintBench.cpp -----------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the cost of adding constraints to a constraint set, which keeps
+// the constraints partitioned into independent sets as they are added.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Expr/Constraints.h"
+#include "klee/Expr/Expr.h"
+#include "klee/Expr/SourceBuilder.h"
+
+#include <benchmark/benchmark.h>
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+using namespace klee;
+
+namespace {
+
+const Array *makeArray(unsigned index) {
+  return Array::create(ConstantExpr::create(256, sizeof(uint64_t) * CHAR_BIT),
+                       SourceBuilder::makeSymbolic("constraint", index));
+}
+
+/// Bounds byte i of `arrays[i % arrays.size()]`
+std::vector<ref<Expr>> makeConstraints(unsigned count, unsigned numArrays) {
+  std::vector<const Array *> arrays;
+  for (unsigned i = 0; i < numArrays; ++i)
+    arrays.push_back(makeArray(i));
+  std::vector<ref<Expr>> constraints;
+  for (unsigned i = 0; i < count; ++i) {
+    ref<Expr> read =
+        Expr::createTempRead(arrays[i % numArrays], Expr::Int8,
+                             ConstantExpr::create(i % 256, Expr::Int32));
+    constraints.push_back(
+        UltExpr::create(read, ConstantExpr::create(100, Expr::Int8)));
+  }
+  return constraints;
+}
+
+void addConstraints(benchmark::State &state,
+                    const std::vector<ref<Expr>> &constraints) {
+  for (auto _ : state) {
+    ConstraintSet cs;
+    for (const auto &constraint : constraints)
+      cs.addConstraint(constraint);
+    benchmark::DoNotOptimize(cs.cs().size());
+  }
+  state.SetItemsProcessed(state.iterations() * constraints.size());
+}
+
+/// Adds range(0) constraints over the same array, which end up in a single
+/// independent set.
+void BM_AddConstraintDependent(benchmark::State &state) {
+  addConstraints(state, makeConstraints(state.range(0), 1));
+}
+
+/// Adds range(0) constraints over as many arrays, each of which forms an
+/// independent set of its own.
+void BM_AddConstraintIndependent(benchmark::State &state) {
+  addConstraints(state, makeConstraints(state.range(0), state.range(0)));
+}
+
+} // namespace
+
+BENCHMARK(BM_AddConstraintDependent)->RangeMultiplier(8)->Range(8, 512);
+BENCHMARK(BM_AddConstraintIndependent)->RangeMultiplier(8)->Range(8, 512);
@@ -0,0 +1,130 @@
+//===-- ExprBench.cpp -----------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the cost of expression hash-consing, reference counting and reads
+// through update lists. Run the same benchmarks in builds with and without
+// ENABLE_THREAD_SAFE_EXPR to see the single-threaded overhead of the
+// thread-safe variant. Builds with ENABLE_THREAD_SAFE_EXPR additionally run
+// the benchmarks concurrently.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Config/config.h"
+#include "klee/Expr/Expr.h"
+#include "klee/Expr/SourceBuilder.h"
+
+#include <benchmark/benchmark.h>
+
+#include <climits>
+#include <cstdint>
+
+using namespace klee;
+
+namespace {
+
+const Array *getArray() {
+  static const Array *array =
+      Array::create(ConstantExpr::create(256, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::makeSymbolic("bench", 0));
+  return array;
+}
+
+ref<Expr> getRead(unsigned index) {
+  return Expr::createTempRead(getArray(), Expr::Int8,
+                              ConstantExpr::create(index, Expr::Int32));
+}
+
+/// Rebuilds an expression which is already cached.
+void BM_HashConsHit(benchmark::State &state) {
+  ref<Expr> lhs = getRead(0);
+  ref<Expr> rhs = getRead(1);
+  ref<Expr> cached = AddExpr::create(lhs, rhs);
+  for (auto _ : state) {
+    ref<Expr> e = AddExpr::create(lhs, rhs);
+    benchmark::DoNotOptimize(e.get());
+  }
+}
+
+/// Builds fresh expressions which are dropped right away.
+void BM_HashConsMiss(benchmark::State &state) {
+  ref<Expr> read = ZExtExpr::create(getRead(0), Expr::Int64);
+  uint64_t value = static_cast<uint64_t>(state.thread_index()) << 32;
+  for (auto _ : state) {
+    ref<Expr> e =
+        AddExpr::create(read, ConstantExpr::create(++value, Expr::Int64));
+    benchmark::DoNotOptimize(e.get());
+  }
+}
+
+/// Looks up constants in the constant cache.
+void BM_ConstantAlloc(benchmark::State &state) {
+  uint64_t value = 0;
+  for (auto _ : state) {
+    ref<ConstantExpr> c = ConstantExpr::alloc(value++ & 0xff, Expr::Int32);
+    benchmark::DoNotOptimize(c.get());
+  }
+}
+
+/// Copies and drops references to a shared expression.
+void BM_RefCopy(benchmark::State &state) {
+  ref<Expr> e = AddExpr::create(getRead(0), getRead(1));
+  for (auto _ : state) {
+    ref<Expr> copy = e;
+    benchmark::DoNotOptimize(copy.get());
+  }
+}
+
+/// Reads the oldest of range(0) updates at concrete indices, which a scan
+/// of the update list finds last.
+void BM_ReadUpdateList(benchmark::State &state) {
+  const Array *array =
+      Array::create(ConstantExpr::create(4096, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::makeSymbolic("updates", 0));
+  UpdateList ul(array, nullptr);
+  for (int64_t i = 0; i < state.range(0); ++i)
+    ul.extend(ConstantExpr::create(i, Expr::Int32), getRead(i % 256));
+  ref<Expr> index = ConstantExpr::create(0, Expr::Int32);
+  for (auto _ : state) {
+    ref<Expr> e = ReadExpr::create(ul, index);
+    benchmark::DoNotOptimize(e.get());
+  }
+}
+
+} // namespace
+
+BENCHMARK(BM_HashConsHit);
+BENCHMARK(BM_HashConsMiss);
+BENCHMARK(BM_ConstantAlloc);
+BENCHMARK(BM_RefCopy);
+BENCHMARK(BM_ReadUpdateList)->RangeMultiplier(8)->Range(8, 4096);
+
+#ifdef KLEE_THREAD_SAFE_EXPR
+// Registered last: once enabled, concurrent reference counting stays on for
+// the remaining benchmarks.
+static void enableConcurrency(const benchmark::State &) {
+  enableConcurrentRefs();
+}
+
+BENCHMARK(BM_HashConsHit)
+    ->Setup(enableConcurrency)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK(BM_HashConsMiss)
+    ->Setup(enableConcurrency)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK(BM_ConstantAlloc)
+    ->Setup(enableConcurrency)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK(BM_RefCopy)
+    ->Setup(enableConcurrency)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+#endif
@@ -0,0 +1,152 @@
+//===-- ForkBench.cpp -----------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the cost of forking a state depending on its call depth, on the
+// size of its side tables and on the number of objects in its address space.
+// Every frame belongs to a function with many registers, all of them set, and
+// the forked state writes a register of its top frame as the executor does
+// right after a branch.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Core/ExecutionState.h"
+#include "Core/Memory.h"
+#include "klee/Core/Context.h"
+#include "klee/Expr/Expr.h"
+#include "klee/Module/KModule.h"
+
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace klee;
+
+namespace {
+
+/// A function computing a chain of `length` additions on its argument
+class ChainFunction {
+  llvm::LLVMContext ctx;
+  std::unique_ptr<llvm::Module> module;
+  KModule kmodule;
+  std::unique_ptr<KFunction> kf;
+
+public:
+  explicit ChainFunction(unsigned length)
+      : module(std::make_unique<llvm::Module>("bench", ctx)) {
+    auto *i64 = llvm::Type::getInt64Ty(ctx);
+    auto *fn = llvm::Function::Create(
+        llvm::FunctionType::get(i64, {i64}, false),
+        llvm::Function::ExternalLinkage, "chain", module.get());
+    llvm::IRBuilder<> builder(llvm::BasicBlock::Create(ctx, "entry", fn));
+    llvm::Value *arg = fn->getArg(0);
+    llvm::Value *value = arg;
+    for (unsigned i = 0; i < length; ++i)
+      value = builder.CreateAdd(value, arg);
+    builder.CreateRet(value);
+    unsigned globalIndex = 0;
+    kf = std::make_unique<KFunction>(fn, &kmodule, globalIndex);
+  }
+
+  KFunction *get() const { return kf.get(); }
+};
+
+ChainFunction &getFunction() {
+  static ChainFunction function(1024);
+  return function;
+}
+
+void setRegisters(StackFrame &frame) {
+  for (unsigned reg = 0; reg < frame.kf->getNumRegisters(); ++reg)
+    frame.locals.set(reg, Cell(ConstantExpr::create(reg, Expr::Int64)));
+}
+
+/// Forks a state with range(0) frames and drops the fork.
+void BM_Branch(benchmark::State &state) {
+  KFunction *kf = getFunction().get();
+  ExecutionState es(kf);
+  for (int64_t depth = 1; depth < state.range(0); ++depth)
+    es.pushFrame(kf->instructions, kf);
+  for (auto &frame : es.stack.valueStack())
+    setRegisters(frame);
+
+  ref<Expr> value = ConstantExpr::create(0, Expr::Int64);
+  for (auto _ : state) {
+    ExecutionState *forked = es.branch();
+    forked->stack.valueStack().back().locals.set(0, Cell(value));
+    benchmark::DoNotOptimize(forked);
+    delete forked;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Forks a state which has resolved range(0) pointers and made range(0)
+/// arrays, and drops the fork after it made one more array.
+void BM_BranchSideTables(benchmark::State &state) {
+  KFunction *kf = getFunction().get();
+  ExecutionState es(kf);
+  auto *type = llvm::Type::getInt8Ty(kf->function()->getContext());
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    ref<Expr> base = ConstantExpr::create(i, Expr::Int64);
+    es.resolvedPointers.replace({base, {}});
+    es.gepExprBases.replace({base, type});
+    es.arrayNames.replace({"array" + std::to_string(i), 1});
+    es.coverNew();
+  }
+
+  for (auto _ : state) {
+    ExecutionState *forked = es.branch();
+    forked->arrayNames.replace({"array", 1});
+    benchmark::DoNotOptimize(forked);
+    delete forked;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Forks a state with range(0) bound objects of 64 bytes and drops the fork
+/// after it wrote to one of them.
+void BM_BranchAddressSpace(benchmark::State &state) {
+  if (!ContextInitialized)
+    Context::initialize(true, Expr::Int64);
+  KFunction *kf = getFunction().get();
+  ExecutionState es(kf);
+  std::vector<ref<const MemoryObject>> objects;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    auto *mo = new MemoryObject(Expr::createPointer(0x10000 + i * 128),
+                                Expr::createPointer(64), 8, false, true, false,
+                                false, nullptr, nullptr);
+    objects.push_back(mo);
+    auto *os = new ObjectState(mo);
+    os->initializeToZero();
+    es.addressSpace.bindObject(mo, os);
+  }
+
+  const MemoryObject *written = objects.front().get();
+  ref<Expr> value = ConstantExpr::create(1, Expr::Int8);
+  for (auto _ : state) {
+    ExecutionState *forked = es.branch();
+    const ObjectState *os = forked->addressSpace.findObject(written).second;
+    forked->addressSpace.getWriteable(written, os)->write(0, value);
+    benchmark::DoNotOptimize(forked);
+    delete forked;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_Branch)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(BM_BranchSideTables)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_BranchAddressSpace)->RangeMultiplier(8)->Range(8, 4096);
@@ -0,0 +1,183 @@
+//===-- MemoryBench.cpp ---------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the cost of resolving concrete pointers in an address space, of
+// reading and writing object contents at concrete and symbolic offsets and of
+// copying an object before writing to it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Core/AddressSpace.h"
+#include "Core/ExecutionState.h"
+#include "Core/Memory.h"
+#include "klee/Core/Context.h"
+#include "klee/Expr/Expr.h"
+#include "klee/Expr/SourceBuilder.h"
+
+#include <benchmark/benchmark.h>
+
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace klee;
+
+namespace {
+
+const uint64_t ObjectSize = 64;
+const uint64_t ObjectStride = 128;
+const uint64_t FirstAddress = 0x10000;
+
+void initializeContext() {
+  if (!ContextInitialized)
+    Context::initialize(true, Expr::Int64);
+}
+
+ref<Expr> getSymbolicOffset() {
+  static const Array *array =
+      Array::create(ConstantExpr::create(8, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::makeSymbolic("offset", 0));
+  ref<Expr> offset = Expr::createTempRead(array, Expr::Int64);
+  return URemExpr::create(offset, Expr::createPointer(ObjectSize));
+}
+
+/// `count` objects of ObjectSize bytes bound in an address space
+struct BoundObjects {
+  std::vector<ref<const MemoryObject>> objects;
+  AddressSpace addressSpace;
+
+  explicit BoundObjects(uint64_t count) {
+    initializeContext();
+    for (uint64_t i = 0; i < count; ++i) {
+      auto *mo = new MemoryObject(
+          Expr::createPointer(FirstAddress + i * ObjectStride),
+          Expr::createPointer(ObjectSize), 8, false, true, false, false,
+          nullptr, nullptr);
+      objects.push_back(mo);
+      auto *os = new ObjectState(mo);
+      os->initializeToZero();
+      addressSpace.bindObject(mo, os);
+    }
+  }
+
+  ref<ConstantPointerExpr> pointerInto(uint64_t index) const {
+    uint64_t base = FirstAddress + index * ObjectStride;
+    return ConstantPointerExpr::create(
+        ConstantExpr::create(base, Expr::Int64),
+        ConstantExpr::create(base + ObjectSize / 2, Expr::Int64));
+  }
+};
+
+/// Resolves concrete pointers into an address space with range(0) objects.
+/// Concrete pointers are resolved without the state and the solver.
+void BM_ResolveConcrete(benchmark::State &state) {
+  BoundObjects bound(state.range(0));
+  ExecutionState es;
+  uint64_t index = 0;
+  for (auto _ : state) {
+    ResolutionList rl;
+    bool incomplete = bound.addressSpace.resolve(
+        es, nullptr, bound.pointerInto(index++ % bound.objects.size()), rl);
+    benchmark::DoNotOptimize(incomplete);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Reads 32-bit values at concrete offsets.
+void BM_ReadConcrete(benchmark::State &state) {
+  BoundObjects bound(1);
+  ObjectState os(bound.objects[0].get());
+  os.initializeToZero();
+  unsigned offset = 0;
+  for (auto _ : state) {
+    ref<Expr> value = os.read(offset, Expr::Int32);
+    offset = (offset + 4) % ObjectSize;
+    benchmark::DoNotOptimize(value.get());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Writes 32-bit values at concrete offsets.
+void BM_WriteConcrete(benchmark::State &state) {
+  BoundObjects bound(1);
+  ObjectState os(bound.objects[0].get());
+  os.initializeToZero();
+  unsigned offset = 0;
+  for (auto _ : state) {
+    os.write(offset, ConstantExpr::create(offset, Expr::Int32));
+    offset = (offset + 4) % ObjectSize;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Reads 32-bit values at a symbolic offset of an object with range(0)
+/// symbolic writes.
+void BM_ReadSymbolic(benchmark::State &state) {
+  BoundObjects bound(1);
+  ObjectState os(bound.objects[0].get());
+  os.initializeToZero();
+  ref<Expr> offset = getSymbolicOffset();
+  for (int64_t i = 0; i < state.range(0); ++i)
+    os.write(offset, ConstantExpr::create(i, Expr::Int8));
+  for (auto _ : state) {
+    ref<Expr> value = os.read(offset, Expr::Int32);
+    benchmark::DoNotOptimize(value.get());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Writes bytes at a symbolic offset, starting over from a fresh object
+/// after every 256 writes.
+void BM_WriteSymbolic(benchmark::State &state) {
+  BoundObjects bound(1);
+  ref<Expr> offset = getSymbolicOffset();
+  ref<Expr> value = ConstantExpr::create(1, Expr::Int8);
+  auto os = std::make_unique<ObjectState>(bound.objects[0].get());
+  unsigned writes = 0;
+  for (auto _ : state) {
+    if (++writes % 256 == 0) {
+      state.PauseTiming();
+      os = std::make_unique<ObjectState>(bound.objects[0].get());
+      state.ResumeTiming();
+    }
+    os->write(offset, value);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Copies a concrete object of range(0) bytes, as getWriteable does after a
+/// fork, and writes a byte of the copy.
+void BM_CopyAndWrite(benchmark::State &state) {
+  initializeContext();
+  ref<const MemoryObject> mo = new MemoryObject(
+      Expr::createPointer(FirstAddress), Expr::createPointer(state.range(0)),
+      8, false, true, false, false, nullptr, nullptr);
+  ObjectState os(mo.get());
+  os.initializeToZero();
+  for (int64_t i = 0; i < state.range(0); ++i)
+    os.write8(i, i);
+  unsigned offset = 0;
+  for (auto _ : state) {
+    ObjectState copy(os);
+    copy.write8(offset, 0xff);
+    offset = (offset + 4099) % state.range(0);
+    benchmark::DoNotOptimize(copy.getMemoryUsage());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK(BM_CopyAndWrite)->RangeMultiplier(16)->Range(64, 1 << 20);
+BENCHMARK(BM_ResolveConcrete)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK(BM_ReadConcrete);
+BENCHMARK(BM_WriteConcrete);
+BENCHMARK(BM_ReadSymbolic)->RangeMultiplier(8)->Range(1, 64);
+BENCHMARK(BM_WriteSymbolic);
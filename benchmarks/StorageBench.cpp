@@ -0,0 +1,71 @@
+//===-- StorageBench.cpp --------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Measures the cost of loading and copying the bytes of a fully set sparse
+// storage, as assignments do when evaluating and copying solutions, with a
+// hash map and with the storage that goes dense as it fills.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/ADT/SparseStorage.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+using namespace klee;
+
+namespace {
+
+template <typename Adapter>
+SparseStorageImpl<unsigned char, std::equal_to<unsigned char>, Adapter>
+makeStorage(size_t size) {
+  SparseStorageImpl<unsigned char, std::equal_to<unsigned char>, Adapter>
+      storage(0);
+  for (size_t i = 0; i < size; ++i)
+    storage.store(i, static_cast<unsigned char>(i | 1));
+  return storage;
+}
+
+/// Loads every byte of a storage of range(0) bytes.
+template <typename Adapter> void BM_StorageLoad(benchmark::State &state) {
+  auto storage = makeStorage<Adapter>(state.range(0));
+  for (auto _ : state) {
+    unsigned sum = 0;
+    for (int64_t i = 0; i < state.range(0); ++i)
+      sum += storage.load(i);
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Copies a storage of range(0) bytes.
+template <typename Adapter> void BM_StorageCopy(benchmark::State &state) {
+  auto storage = makeStorage<Adapter>(state.range(0));
+  for (auto _ : state) {
+    auto copy = storage;
+    benchmark::DoNotOptimize(copy.storage().size());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_StorageLoad, UnorderedMapAdapder<unsigned char>)
+    ->RangeMultiplier(16)
+    ->Range(16, 4096);
+BENCHMARK_TEMPLATE(BM_StorageLoad, DensityAdapter<unsigned char>)
+    ->RangeMultiplier(16)
+    ->Range(16, 4096);
+BENCHMARK_TEMPLATE(BM_StorageCopy, UnorderedMapAdapder<unsigned char>)
+    ->RangeMultiplier(16)
+    ->Range(16, 4096);
+BENCHMARK_TEMPLATE(BM_StorageCopy, DensityAdapter<unsigned char>)
+    ->RangeMultiplier(16)
+    ->Range(16, 4096);
@@ -0,0 +1,38 @@
+//===-- CopyOnWrite.h -------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_COPYONWRITE_H
+#define KLEE_COPYONWRITE_H
+
+#include <memory>
+
+namespace klee {
+
+/// Holds a value which is shared by all copies of the holder. The value is
+/// copied the first time a holder which shares it asks to modify it, so
+/// copying a holder costs the same whatever the size of the value.
+template <class T> class CopyOnWrite {
+  std::shared_ptr<T> value;
+
+public:
+  CopyOnWrite() : value(std::make_shared<T>()) {}
+
+  const T &operator*() const { return *value; }
+  const T *operator->() const { return value.get(); }
+
+  /// Returns the value for modification, copying it first if it is shared
+  T &mutate() {
+    if (value.use_count() > 1)
+      value = std::make_shared<T>(*value);
+    return *value;
+  }
+};
+} // namespace klee
+
+#endif /* KLEE_COPYONWRITE_H */
@@ -29,9 +29,13 @@
 #ifndef KLEE_REF_H
 #define KLEE_REF_H
 
+#include "klee/Config/config.h"
 #include "klee/Support/Casting.h"
 
 #include <cassert>
+#ifdef KLEE_THREAD_SAFE_EXPR
+#include <atomic>
+#endif
 
 namespace llvm {
 class raw_ostream;
@@ -41,6 +45,20 @@ namespace klee {
 
 template <class T> class ref;
 
+#ifdef KLEE_THREAD_SAFE_EXPR
+/// Set once ref-managed objects may be shared between threads. From then on,
+/// reference counts are updated with atomic operations and the expression
+/// caches are locked. Until then, single-threaded runs do not pay for thread
+/// safety. Must be set before a second thread starts and is never reset.
+inline std::atomic<bool> concurrentRefs{false};
+
+inline void enableConcurrentRefs() { concurrentRefs.store(true); }
+
+inline bool isConcurrentRefs() {
+  return concurrentRefs.load(std::memory_order_relaxed);
+}
+#endif
+
 /// Reference counter to be used as part of a ref-managed struct or class
 class ReferenceCounter {
   template <class T> friend class ref;
@@ -48,6 +66,25 @@ class ReferenceCounter {
   /// Count how often the object has been referenced.
   unsigned refCount = 0;
 
+  void increment() {
+#ifdef KLEE_THREAD_SAFE_EXPR
+    if (isConcurrentRefs()) {
+      __atomic_fetch_add(&refCount, 1, __ATOMIC_RELAXED);
+      return;
+    }
+#endif
+    ++refCount;
+  }
+
+  /// Returns true if the last reference has been dropped.
+  bool release() {
+#ifdef KLEE_THREAD_SAFE_EXPR
+    if (isConcurrentRefs())
+      return __atomic_sub_fetch(&refCount, 1, __ATOMIC_ACQ_REL) == 0;
+#endif
+    return --refCount == 0;
+  }
+
 public:
   ReferenceCounter() = default;
   ~ReferenceCounter() = default;
@@ -61,6 +98,35 @@ public:
   /// \return number of references on this object
   unsigned getCount() { return refCount; }
 
+  /// Takes an additional reference unless the object is already being
+  /// destroyed. Used by shared caches which hold objects without owning them.
+  /// \return true if a reference has been taken
+  bool tryAcquire() {
+#ifdef KLEE_THREAD_SAFE_EXPR
+    if (isConcurrentRefs()) {
+      unsigned count = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
+      while (count != 0) {
+        if (__atomic_compare_exchange_n(&refCount, &count, count + 1, true,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+          return true;
+      }
+      return false;
+    }
+#endif
+    if (refCount == 0)
+      return false;
+    ++refCount;
+    return true;
+  }
+
+  /// Drops a reference taken by tryAcquire() while the object is kept alive
+  /// by some ref<>.
+  void releaseAcquired() {
+    bool last = release();
+    assert(!last && "object must be kept alive by another reference");
+    (void)last;
+  }
+
   // Copy assignment operator
   ReferenceCounter &operator=(const ReferenceCounter &a) {
     if (this == &a)
@@ -87,11 +153,11 @@ public:
 private:
   void inc() const {
     if (ptr)
-      ++ptr->_refCount.refCount;
+      ptr->_refCount.increment();
   }
 
   void dec() const {
-    if (ptr && --ptr->_refCount.refCount == 0)
+    if (ptr && ptr->_refCount.release())
       delete ptr;
   }
 
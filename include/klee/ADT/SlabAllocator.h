@@ -0,0 +1,89 @@
+//===-- SlabAllocator.h -----------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_SLABALLOCATOR_H
+#define KLEE_SLABALLOCATOR_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace klee {
+
+/// Hands out small blocks carved from large slabs, with one size class per
+/// Granularity bytes. Freed blocks go to the free list of their class and
+/// are handed out again first, so allocating and freeing take constant
+/// time. Slabs are only released with the allocator. Blocks larger than
+/// MaxBlockSize come from the global allocator. Not thread-safe.
+class SlabAllocator {
+public:
+  static constexpr size_t Granularity = 16;
+  static constexpr size_t MaxBlockSize = 512;
+  static constexpr size_t SlabSize = 64 * 1024;
+
+private:
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+
+  std::array<FreeBlock *, MaxBlockSize / Granularity> freeLists{};
+  std::vector<std::unique_ptr<char[]>> slabs;
+  char *slabCursor = nullptr;
+  char *slabEnd = nullptr;
+
+  static size_t getClass(size_t size) {
+    return (size + Granularity - 1) / Granularity - 1;
+  }
+
+public:
+  SlabAllocator() = default;
+  SlabAllocator(const SlabAllocator &) = delete;
+  SlabAllocator &operator=(const SlabAllocator &) = delete;
+
+  void *allocate(size_t size) {
+    if (size == 0 || size > MaxBlockSize)
+      return ::operator new(size);
+    size_t sizeClass = getClass(size);
+    if (FreeBlock *block = freeLists[sizeClass]) {
+      freeLists[sizeClass] = block->next;
+      return block;
+    }
+    size_t blockSize = (sizeClass + 1) * Granularity;
+    if (static_cast<size_t>(slabEnd - slabCursor) < blockSize) {
+      slabs.emplace_back(new char[SlabSize]);
+      slabCursor = slabs.back().get();
+      slabEnd = slabCursor + SlabSize;
+    }
+    void *block = slabCursor;
+    slabCursor += blockSize;
+    return block;
+  }
+
+  void deallocate(void *ptr, size_t size) {
+    if (size == 0 || size > MaxBlockSize) {
+      ::operator delete(ptr);
+      return;
+    }
+    assert(ptr && "freeing a null block");
+    size_t sizeClass = getClass(size);
+    FreeBlock *block = static_cast<FreeBlock *>(ptr);
+    block->next = freeLists[sizeClass];
+    freeLists[sizeClass] = block;
+  }
+
+  /// Returns the bytes held in slabs, which grow with the peak of the bytes
+  /// handed out in small blocks at once
+  size_t getSlabBytes() const { return slabs.size() * SlabSize; }
+};
+} // namespace klee
+
+#endif /* KLEE_SLABALLOCATOR_H */
@@ -23,10 +23,6 @@ class raw_ostream;
 };
 
 namespace klee {
-enum class Density {
-  Sparse,
-  Dense,
-};
 
 template <typename ValueType, typename Eq = std::equal_to<ValueType>>
 class SparseStorage {
@@ -102,7 +98,7 @@ public:
 };
 
 template <typename ValueType, typename Eq = std::equal_to<ValueType>,
-          typename InternalStorageAdapter = UnorderedMapAdapder<ValueType, Eq>,
+          typename InternalStorageAdapter = DensityAdapter<ValueType, Eq>,
           typename Constructor = typename InternalStorageAdapter::constructor>
 class SparseStorageImpl : public SparseStorage<ValueType, Eq> {
 private:
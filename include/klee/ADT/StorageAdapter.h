@@ -11,16 +11,32 @@
 #include <immer/vector.hpp>
 #include <immer/vector_transient.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace llvm {
 class raw_ostream;
 };
 
 namespace klee {
-enum class StorageIteratorKind { UMap, PersistentUMap, SparseArray };
+enum class Density {
+  Sparse,
+  Dense,
+};
+
+enum class StorageIteratorKind {
+  UMap,
+  PersistentUMap,
+  SparseArray,
+  PagedArray,
+  DenseChunks
+};
 
 template <typename ValueType> struct UnorderedMapAdapterIterator {
   using storage_ty = std::unordered_map<size_t, ValueType>;
@@ -95,11 +111,57 @@ public:
   SparseArrayAdapterIterator(storage_ty it) : it(it) {}
 };
 
+template <typename ValueType, typename Eq> struct PagedArrayAdapter;
+
+template <typename ValueType, typename Eq = std::equal_to<ValueType>>
+struct PagedArrayAdapterIterator {
+  using storage_ty = PagedArrayAdapter<ValueType, Eq>;
+  using value_ty = std::pair<size_t, ValueType>;
+  const storage_ty *storage;
+  size_t index;
+
+public:
+  PagedArrayAdapterIterator(const storage_ty *_storage, size_t _index)
+      : storage(_storage), index(_storage->skipDefaults(_index)) {}
+  PagedArrayAdapterIterator &operator++() {
+    index = storage->skipDefaults(index + 1);
+    return *this;
+  }
+  value_ty operator*() { return {index, storage->at(index)}; }
+  bool operator!=(const PagedArrayAdapterIterator &other) const {
+    return other.storage != storage || other.index != index;
+  }
+};
+
+template <typename ValueType, typename Eq> struct DensityAdapter;
+
+template <typename ValueType, typename Eq = std::equal_to<ValueType>>
+struct DenseChunksIterator {
+  using storage_ty = DensityAdapter<ValueType, Eq>;
+  using value_ty = std::pair<size_t, ValueType>;
+  const storage_ty *storage;
+  size_t index;
+
+public:
+  DenseChunksIterator(const storage_ty *_storage, size_t _index)
+      : storage(_storage), index(_storage->nextSet(_index)) {}
+  DenseChunksIterator &operator++() {
+    index = storage->nextSet(index + 1);
+    return *this;
+  }
+  value_ty operator*() { return {index, storage->at(index)}; }
+  bool operator!=(const DenseChunksIterator &other) const {
+    return other.storage != storage || other.index != index;
+  }
+};
+
 template <typename ValueType, typename Eq = std::equal_to<ValueType>>
 union StorageIterator {
   UnorderedMapAdapterIterator<ValueType> umaIt;
   PersistentMapAdapterIterator<ValueType> pumaIt;
   SparseArrayAdapterIterator<ValueType, Eq> saaIt;
+  PagedArrayAdapterIterator<ValueType, Eq> paaIt;
+  DenseChunksIterator<ValueType, Eq> dcIt;
   ~StorageIterator() {}
   StorageIterator(const UnorderedMapAdapterIterator<ValueType> &other)
       : umaIt(other) {}
@@ -107,6 +169,10 @@ union StorageIterator {
       : pumaIt(other) {}
   StorageIterator(const SparseArrayAdapterIterator<ValueType, Eq> &other)
       : saaIt(other) {}
+  StorageIterator(const PagedArrayAdapterIterator<ValueType, Eq> &other)
+      : paaIt(other) {}
+  StorageIterator(const DenseChunksIterator<ValueType, Eq> &other)
+      : dcIt(other) {}
 };
 
 template <typename ValueType, typename Eq = std::equal_to<ValueType>>
@@ -124,6 +190,10 @@ struct StorageAdapter {
         : kind(StorageIteratorKind::PersistentUMap), impl(impl) {}
     iterator(const SparseArrayAdapterIterator<ValueType, Eq> &impl)
         : kind(StorageIteratorKind::SparseArray), impl(impl) {}
+    iterator(const PagedArrayAdapterIterator<ValueType, Eq> &impl)
+        : kind(StorageIteratorKind::PagedArray), impl(impl) {}
+    iterator(const DenseChunksIterator<ValueType, Eq> &impl)
+        : kind(StorageIteratorKind::DenseChunks), impl(impl) {}
     iterator(iterator const &right) : kind(right.kind) {
       switch (kind) {
       case klee::StorageIteratorKind::UMap: {
@@ -138,6 +208,14 @@ struct StorageAdapter {
         impl.saaIt = right.impl.saaIt;
         break;
       }
+      case klee::StorageIteratorKind::PagedArray: {
+        impl.paaIt = right.impl.paaIt;
+        break;
+      }
+      case klee::StorageIteratorKind::DenseChunks: {
+        impl.dcIt = right.impl.dcIt;
+        break;
+      }
       default:
         assert(0 && "unhandled iterator kind");
         unreachable();
@@ -157,6 +235,14 @@ struct StorageAdapter {
         impl.saaIt.~SparseArrayAdapterIterator();
         break;
       }
+      case klee::StorageIteratorKind::PagedArray: {
+        impl.paaIt.~PagedArrayAdapterIterator();
+        break;
+      }
+      case klee::StorageIteratorKind::DenseChunks: {
+        impl.dcIt.~DenseChunksIterator();
+        break;
+      }
       default:
         assert(0 && "unhandled iterator kind");
         unreachable();
@@ -178,6 +264,14 @@ struct StorageAdapter {
         ++impl.saaIt;
         break;
       }
+      case klee::StorageIteratorKind::PagedArray: {
+        ++impl.paaIt;
+        break;
+      }
+      case klee::StorageIteratorKind::DenseChunks: {
+        ++impl.dcIt;
+        break;
+      }
       default:
         assert(0 && "unhandled iterator kind");
         unreachable();
@@ -195,6 +289,12 @@ struct StorageAdapter {
       case klee::StorageIteratorKind::SparseArray: {
         return *impl.saaIt;
       }
+      case klee::StorageIteratorKind::PagedArray: {
+        return *impl.paaIt;
+      }
+      case klee::StorageIteratorKind::DenseChunks: {
+        return *impl.dcIt;
+      }
       default:
         assert(0 && "unhandled iterator kind");
         unreachable();
@@ -211,6 +311,12 @@ struct StorageAdapter {
       case klee::StorageIteratorKind::SparseArray: {
         return impl.saaIt != other.impl.saaIt;
       }
+      case klee::StorageIteratorKind::PagedArray: {
+        return impl.paaIt != other.impl.paaIt;
+      }
+      case klee::StorageIteratorKind::DenseChunks: {
+        return impl.dcIt != other.impl.dcIt;
+      }
       default:
         assert(0 && "unhandled iterator kind");
         unreachable();
@@ -228,6 +334,8 @@ struct StorageAdapter {
   virtual const ValueType &at(size_t key) const = 0;
   virtual void clear() = 0;
   virtual size_t size() const = 0;
+  /// Estimated number of bytes allocated for the stored values
+  virtual size_t getMemoryUsage() const = 0;
 };
 
 template <typename ValueType, typename Eq = std::equal_to<ValueType>>
@@ -269,6 +377,188 @@ public:
   const ValueType &at(size_t key) const override { return storage.at(key); }
   void clear() override { storage.clear(); }
   size_t size() const override { return storage.size(); }
+  size_t getMemoryUsage() const override {
+    return storage.size() *
+               (sizeof(typename storage_ty::value_type) + sizeof(void *)) +
+           storage.bucket_count() * sizeof(void *);
+  }
+};
+
+/// Stores values in a hash map while they are sparse, and in contiguous
+/// chunks with a bitmap of the set indexes once they fill enough of the range
+/// below the largest index. The representation follows the fill ratio both
+/// ways, with some slack so that it does not flip on every change.
+template <typename ValueType, typename Eq = std::equal_to<ValueType>>
+struct DensityAdapter : public StorageAdapter<ValueType, Eq> {
+  static constexpr size_t ChunkSize = 64;
+  /// A map with at least this many values goes dense once they fill a
+  /// quarter of its range
+  static constexpr size_t MinDenseSize = 16;
+  /// Chunks go sparse once their values fill less than one in this many
+  /// indexes
+  static constexpr size_t SparseRatio = 16;
+
+  struct Chunk {
+    std::array<ValueType, ChunkSize> values;
+    uint64_t present = 0;
+  };
+
+  using map_ty = std::unordered_map<size_t, ValueType>;
+  using chunks_ty = std::vector<Chunk>;
+  using base_ty = StorageAdapter<ValueType, Eq>;
+  using iterator = typename base_ty::iterator;
+  struct constructor {
+    DensityAdapter<ValueType, Eq> operator()(const ValueType &) const {
+      return DensityAdapter<ValueType, Eq>();
+    }
+  };
+
+private:
+  Density density = Density::Sparse;
+  map_ty map;
+  chunks_ty chunks;
+  /// Sparse: one past the largest index set since the map was last empty.
+  /// Dense: number of set indexes.
+  size_t rangeEnd = 0, denseSize = 0;
+
+  void makeDense() {
+    chunks.resize((rangeEnd + ChunkSize - 1) / ChunkSize);
+    for (const auto &[key, value] : map) {
+      auto &chunk = chunks[key / ChunkSize];
+      chunk.values[key % ChunkSize] = value;
+      chunk.present |= uint64_t(1) << (key % ChunkSize);
+    }
+    denseSize = map.size();
+    map = map_ty();
+    density = Density::Dense;
+  }
+
+  void makeSparse() {
+    map.reserve(denseSize);
+    rangeEnd = 0;
+    for (size_t key = nextSet(0); key < capacity(); key = nextSet(key + 1)) {
+      map.emplace(key, at(key));
+      rangeEnd = key + 1;
+    }
+    chunks = chunks_ty();
+    denseSize = 0;
+    density = Density::Sparse;
+  }
+
+  size_t capacity() const { return chunks.size() * ChunkSize; }
+
+public:
+  DensityAdapter() = default;
+
+  Density getDensity() const { return density; }
+
+  /// Returns the first set index from `key` on in dense mode, or the
+  /// capacity of the chunks if there is none.
+  size_t nextSet(size_t key) const {
+    while (key < capacity()) {
+      uint64_t bits = chunks[key / ChunkSize].present >> (key % ChunkSize);
+      if (bits) {
+        return key + __builtin_ctzll(bits);
+      }
+      key = (key / ChunkSize + 1) * ChunkSize;
+    }
+    return capacity();
+  }
+
+  bool contains(size_t key) const override { return lookup(key) != nullptr; }
+  iterator begin() const override {
+    if (density == Density::Sparse) {
+      return iterator(UnorderedMapAdapterIterator<ValueType>(map.begin()));
+    }
+    return iterator(DenseChunksIterator<ValueType, Eq>(this, 0));
+  }
+  iterator end() const override {
+    if (density == Density::Sparse) {
+      return iterator(UnorderedMapAdapterIterator<ValueType>(map.end()));
+    }
+    return iterator(DenseChunksIterator<ValueType, Eq>(this, capacity()));
+  }
+  const ValueType *lookup(size_t key) const override {
+    if (density == Density::Sparse) {
+      auto it = map.find(key);
+      return it != map.end() ? &it->second : nullptr;
+    }
+    if (key >= capacity()) {
+      return nullptr;
+    }
+    const auto &chunk = chunks[key / ChunkSize];
+    if (!(chunk.present >> (key % ChunkSize) & 1)) {
+      return nullptr;
+    }
+    return &chunk.values[key % ChunkSize];
+  }
+  bool empty() const override { return size() == 0; }
+  void set(size_t key, const ValueType &value) override {
+    if (density == Density::Dense && key >= capacity()) {
+      if ((denseSize + 1) * SparseRatio < key + 1) {
+        makeSparse();
+      } else {
+        chunks.resize(key / ChunkSize + 1);
+      }
+    }
+    if (density == Density::Sparse) {
+      map[key] = value;
+      rangeEnd = std::max(rangeEnd, key + 1);
+      if (map.size() >= MinDenseSize && map.size() * 4 >= rangeEnd) {
+        makeDense();
+      }
+      return;
+    }
+    auto &chunk = chunks[key / ChunkSize];
+    uint64_t bit = uint64_t(1) << (key % ChunkSize);
+    if (!(chunk.present & bit)) {
+      chunk.present |= bit;
+      ++denseSize;
+    }
+    chunk.values[key % ChunkSize] = value;
+  }
+  void remove(size_t key) override {
+    if (density == Density::Sparse) {
+      map.erase(key);
+      if (map.empty()) {
+        rangeEnd = 0;
+      }
+      return;
+    }
+    if (!lookup(key)) {
+      return;
+    }
+    auto &chunk = chunks[key / ChunkSize];
+    chunk.present &= ~(uint64_t(1) << (key % ChunkSize));
+    chunk.values[key % ChunkSize] = ValueType();
+    --denseSize;
+    if (denseSize * SparseRatio < capacity()) {
+      makeSparse();
+    }
+  }
+  const ValueType &at(size_t key) const override {
+    if (density == Density::Sparse) {
+      return map.at(key);
+    }
+    return chunks[key / ChunkSize].values[key % ChunkSize];
+  }
+  void clear() override {
+    map = map_ty();
+    chunks = chunks_ty();
+    rangeEnd = 0;
+    denseSize = 0;
+    density = Density::Sparse;
+  }
+  size_t size() const override {
+    return density == Density::Sparse ? map.size() : denseSize;
+  }
+  size_t getMemoryUsage() const override {
+    if (density == Density::Dense) {
+      return chunks.size() * sizeof(Chunk);
+    }
+    return map.size() * (sizeof(typename map_ty::value_type) + sizeof(void *)) +
+           map.bucket_count() * sizeof(void *);
+  }
 };
 
 template <typename ValueType, typename Eq = std::equal_to<ValueType>>
@@ -307,6 +597,9 @@ public:
   const ValueType &at(size_t key) const override { return storage.at(key); }
   void clear() override { storage.clear(); }
   size_t size() const override { return storage.size(); }
+  size_t getMemoryUsage() const override {
+    return storage.size() * sizeof(std::pair<size_t, ValueType>);
+  }
 };
 
 template <typename ValueType, typename Eq = std::equal_to<ValueType>>
@@ -399,6 +692,138 @@ public:
     nonDefaultValuesCount = 0;
   }
   size_t size() const override { return nonDefaultValuesCount; }
+  size_t getMemoryUsage() const override {
+    return storageSize * sizeof(ValueType);
+  }
+};
+
+/// A fixed size array split into pages of PageSize values. Copies of the
+/// array share their pages, and a page is copied the first time a value in it
+/// is changed, so that copying an array after a fork costs a pointer per page
+/// and a write costs at most one page. Pages holding only the default value
+/// are not allocated.
+template <typename ValueType, typename Eq = std::equal_to<ValueType>>
+struct PagedArrayAdapter : public StorageAdapter<ValueType, Eq> {
+  static constexpr size_t PageSize = 4096;
+
+  using page_ty = std::array<ValueType, PageSize>;
+  using storage_ty = std::vector<std::shared_ptr<page_ty>>;
+  using base_ty = StorageAdapter<ValueType, Eq>;
+  using iterator = typename base_ty::iterator;
+  struct constructor {
+    size_t storageSize;
+    constructor(size_t storageSize) : storageSize(storageSize) {}
+    PagedArrayAdapter<ValueType, Eq>
+    operator()(const ValueType &defaultValue) const {
+      return PagedArrayAdapter<ValueType, Eq>(defaultValue, storageSize);
+    }
+  };
+
+private:
+  storage_ty pages;
+  size_t storageSize;
+  ValueType defaultValue;
+  size_t nonDefaultValuesCount;
+
+  page_ty &getWriteablePage(size_t key) {
+    auto &page = pages[key / PageSize];
+    if (!page) {
+      page = std::make_shared<page_ty>();
+      page->fill(defaultValue);
+    } else if (page.use_count() > 1) {
+      page = std::make_shared<page_ty>(*page);
+    }
+    return *page;
+  }
+
+public:
+  PagedArrayAdapter(const ValueType &defaultValue, size_t storageSize)
+      : pages((storageSize + PageSize - 1) / PageSize),
+        storageSize(storageSize), defaultValue(defaultValue),
+        nonDefaultValuesCount(0) {}
+
+  /// Returns the first index from `key` on holding a value other than the
+  /// default one, or the size of the array if there is none.
+  size_t skipDefaults(size_t key) const {
+    while (key < storageSize) {
+      const auto &page = pages[key / PageSize];
+      if (!page) {
+        key = (key / PageSize + 1) * PageSize;
+      } else if (Eq()((*page)[key % PageSize], defaultValue)) {
+        ++key;
+      } else {
+        return key;
+      }
+    }
+    return storageSize;
+  }
+
+  bool contains(size_t key) const override { return lookup(key) != nullptr; }
+  iterator begin() const override {
+    return iterator(PagedArrayAdapterIterator<ValueType, Eq>(this, 0));
+  }
+  iterator end() const override {
+    return iterator(
+        PagedArrayAdapterIterator<ValueType, Eq>(this, storageSize));
+  }
+  const ValueType *lookup(size_t key) const override {
+    if (key >= storageSize) {
+      return nullptr;
+    }
+    const auto &page = pages[key / PageSize];
+    if (!page || Eq()((*page)[key % PageSize], defaultValue)) {
+      return nullptr;
+    }
+    return &(*page)[key % PageSize];
+  }
+  bool empty() const override { return nonDefaultValuesCount == 0; }
+  void set(size_t key, const ValueType &value) override {
+    bool wasDefault = !lookup(key);
+    bool newDefault = Eq()(value, defaultValue);
+    if (wasDefault && newDefault) {
+      return;
+    }
+    if (wasDefault) {
+      ++nonDefaultValuesCount;
+    }
+    if (newDefault) {
+      --nonDefaultValuesCount;
+    }
+    getWriteablePage(key)[key % PageSize] = value;
+  }
+  void remove(size_t key) override { set(key, defaultValue); }
+  const ValueType &at(size_t key) const override {
+    const auto &page = pages[key / PageSize];
+    return page ? (*page)[key % PageSize] : defaultValue;
+  }
+  void clear() override {
+    for (auto &page : pages) {
+      page.reset();
+    }
+    nonDefaultValuesCount = 0;
+  }
+  size_t size() const override { return nonDefaultValuesCount; }
+  /// Pages shared with other arrays are attributed to all of them in equal
+  /// parts.
+  size_t getMemoryUsage() const override {
+    size_t usage = pages.size() * sizeof(typename storage_ty::value_type);
+    for (const auto &page : pages) {
+      if (page) {
+        usage += sizeof(page_ty) / page.use_count();
+      }
+    }
+    return usage;
+  }
+  /// Number of pages this array shares with others
+  size_t sharedPages() const {
+    size_t shared = 0;
+    for (const auto &page : pages) {
+      if (page && page.use_count() > 1) {
+        ++shared;
+      }
+    }
+    return shared;
+  }
 };
 
 } // namespace klee
@@ -98,6 +98,12 @@ public:
 
   void changeCS(constraints_ty &cs);
 
+  /// Replaces the constraints `removed`, which must make up whole
+  /// independent sets without symcretes, with `added`. Unlike changeCS, the
+  /// other independent sets are kept.
+  void replaceConstraints(const constraints_ty &removed,
+                          const constraints_ty &added);
+
   const constraints_ty &cs() const;
   const symcretes_ty &symcretes() const;
   const Assignment &concretization() const;
@@ -136,6 +142,12 @@ public:
   static PathConstraints concat(const PathConstraints &l,
                                 const PathConstraints &r);
 
+  /// Returns the constraints shared by `l` and `r` together with the
+  /// disjunction of the remaining ones, keeping the path of `l`. Sets
+  /// `inL` to the conjunction of the constraints only `l` has.
+  static PathConstraints join(const PathConstraints &l,
+                              const PathConstraints &r, ref<Expr> &inL);
+
 private:
   Path _path;
   constraints_ty _original;
@@ -23,6 +23,8 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <unordered_set>
@@ -121,15 +123,54 @@ protected:
     }
   };
 
+#ifdef KLEE_THREAD_SAFE_EXPR
+  /// Cached expressions are matched structurally by createCachedExpr() after
+  /// they have been safely acquired, so the set itself only compares
+  /// pointers.
+  typedef std::unordered_set<Expr *, ExprHash> CacheType;
+  /// Number of independently locked parts of each hash-consing table.
+  static const unsigned CacheShards = 64;
+  /// Locking is skipped until enableConcurrentRefs() has been called.
+  struct CacheMutex {
+    std::mutex mutex;
+    void lock() {
+      if (isConcurrentRefs())
+        mutex.lock();
+    }
+    void unlock() {
+      if (isConcurrentRefs())
+        mutex.unlock();
+    }
+  };
+#else
   typedef std::unordered_set<Expr *, ExprHash, ExprCmp> CacheType;
+  static const unsigned CacheShards = 1;
+  struct CacheMutex {
+    void lock() {}
+    void unlock() {}
+  };
+#endif
+
+  /// Hash-consing tables are split into shards by hash, each guarded by its
+  /// own lock. Without KLEE_THREAD_SAFE_EXPR there is a single shard and
+  /// locking is a no-op.
+  template <class Cache> struct CacheShard {
+    CacheMutex mutex;
+    Cache cache;
+  };
 
   struct ExprCacheSet {
-    CacheType cache;
+    CacheShard<CacheType> shards[CacheShards];
+    CacheShard<CacheType> &shardFor(unsigned hash) {
+      return shards[hash % CacheShards];
+    }
     ~ExprCacheSet() {
-      while (cache.size() != 0) {
-        ref<Expr> tmp = *cache.begin();
-        tmp->isCached = false;
-        cache.erase(cache.begin());
+      for (auto &shard : shards) {
+        while (shard.cache.size() != 0) {
+          ref<Expr> tmp = *shard.cache.begin();
+          tmp->isCached = false;
+          shard.cache.erase(shard.cache.begin());
+        }
       }
     }
   };
@@ -150,8 +191,14 @@ protected:
     }
   };
 
+  typedef std::unordered_map<llvm::APInt, ConstantExpr *, APIntHash, APIntEq>
+      ConstantCacheType;
+
   struct ConstantExprCacheSet {
-    std::unordered_map<llvm::APInt, ConstantExpr *, APIntHash, APIntEq> cache;
+    CacheShard<ConstantCacheType> shards[CacheShards];
+    CacheShard<ConstantCacheType> &shardFor(const llvm::APInt &v) {
+      return shards[APIntHash()(v) % CacheShards];
+    }
     ~ConstantExprCacheSet();
   };
 
@@ -313,7 +360,15 @@ protected:
   virtual int compareContents(const Expr &b) const = 0;
 
 public:
-  Expr() { Expr::count++; }
+  Expr() {
+#ifdef KLEE_THREAD_SAFE_EXPR
+    if (isConcurrentRefs()) {
+      __atomic_fetch_add(&Expr::count, 1, __ATOMIC_RELAXED);
+      return;
+    }
+#endif
+    Expr::count++;
+  }
   virtual ~Expr();
 
   virtual Kind getKind() const = 0;
@@ -596,6 +651,8 @@ public:
 };
 
 /// Class representing a byte update of an array.
+class UpdateIndex;
+
 class UpdateNode {
   friend class UpdateList;
 
@@ -614,12 +671,30 @@ private:
   /// size of this update sequence, including this update
   unsigned size;
 
+  /// size of this update sequence after it was last compacted
+  unsigned compactedSize;
+
+  /// latest update of each concrete index written by this update and the
+  /// ones below it, down to the first update at a symbolic index; only kept
+  /// for long update sequences
+  std::shared_ptr<const UpdateIndex> concreteIndex;
+
+  void buildIndex();
+
 public:
   UpdateNode(const ref<UpdateNode> &_next, const ref<Expr> &_index,
              const ref<Expr> &_value);
 
   unsigned getSize() const { return size; }
 
+  bool isIndexed() const { return concreteIndex != nullptr; }
+
+  /// Returns the update at which a scan of this indexed sequence for the
+  /// concrete `index` stops: the latest update at `index` if it is not
+  /// below an update at a symbolic index, or else the first update at a
+  /// symbolic index, or null if there is neither.
+  UpdateNode *findConcrete(uint64_t index) const;
+
   int compare(const UpdateNode &b) const;
   bool equals(const UpdateNode &b) const;
   unsigned hash() const { return hashValue; }
@@ -730,6 +805,12 @@ public:
 
   unsigned hash() const;
   unsigned height() const;
+
+private:
+  /// Drops the updates overwritten by later updates at the same concrete
+  /// index, and folds the constant updates at the bottom of the list into
+  /// a copy of a constant root array.
+  void compact();
 };
 
 /// Class representing a one byte read from an array.
@@ -1538,17 +1619,32 @@ public:
   void toMemory(void *address);
 
   static ref<ConstantExpr> alloc(const llvm::APInt &v) {
-    auto success = cachedConstantExpressions.cache.find(v);
-    if (success == cachedConstantExpressions.cache.end()) {
-      // Cache miss
-      ref<ConstantExpr> r = new ConstantExpr(v);
-      r->computeHash();
-      r->computeHeight();
-      r->isCached = true;
-      cachedConstantExpressions.cache[v] = r.get();
-      return r;
+    auto &shard = cachedConstantExpressions.shardFor(v);
+    std::lock_guard<CacheMutex> lock(shard.mutex);
+    auto success = shard.cache.find(v);
+    if (success != shard.cache.end()) {
+#ifdef KLEE_THREAD_SAFE_EXPR
+      // The cached constant may concurrently be dropped by another thread;
+      // its destructor will find it already replaced.
+      ConstantExpr *cached = success->second;
+      if (cached->_refCount.tryAcquire()) {
+        ref<ConstantExpr> r(cached);
+        cached->_refCount.releaseAcquired();
+        return r;
+      }
+      cached->isCached = false;
+      shard.cache.erase(success);
+#else
+      return success->second;
+#endif
     }
-    return success->second;
+    // Cache miss
+    ref<ConstantExpr> r = new ConstantExpr(v);
+    r->computeHash();
+    r->computeHeight();
+    r->isCached = true;
+    shard.cache.emplace(v, r.get());
+    return r;
   }
 
   static ref<ConstantExpr> alloc(const llvm::APFloat &f) {
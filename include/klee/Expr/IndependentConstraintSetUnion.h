@@ -43,6 +43,11 @@ public:
   void addExpr(ref<Expr> e);
   void addSymcrete(ref<Symcrete> s);
   void flushConstraints();
+
+  /// Removes the given constraints. The other constraints of their groups
+  /// are added back, so the groups are split again if they no longer
+  /// intersect. The groups must not hold symcretes.
+  void removeExprs(const constraints_ty &exprs);
 };
 } // namespace klee
 
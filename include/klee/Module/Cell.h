@@ -12,13 +12,63 @@
 
 #include "klee/Expr/Expr.h"
 
+#include <cstdint>
+
 namespace klee {
 class MemoryObject;
 
+/// A register value. Concrete values of at most 64 bits are also kept
+/// inline, so concrete instructions can compute their results from the bits
+/// directly. The expression of an inline value is only built once it is
+/// asked for.
 struct Cell {
-  ref<Expr> value;
+private:
+  mutable ref<Expr> expr;
+  uint64_t bits = 0;
+  /// Width of the inline value, or 0 if the cell holds no inline value.
+  Expr::Width width = 0;
+
+public:
   Cell() = default;
-  explicit Cell(ref<Expr> value) : value(value) {}
+
+  explicit Cell(ref<Expr> value) : expr(value) {
+    if (ConstantExpr *ce = dyn_cast_or_null<ConstantExpr>(value)) {
+      if (ce->getWidth() <= Expr::Int64) {
+        bits = ce->getZExtValue();
+        width = ce->getWidth();
+      }
+    }
+  }
+
+  /// Creates an inline value. Bits above `width` are ignored.
+  Cell(uint64_t value, Expr::Width width)
+      : bits(value & bits64::maxValueOfNBits(width)), width(width) {
+    assert(width > 0 && width <= Expr::Int64 && "invalid inline width");
+  }
+
+  bool isNull() const { return width == 0 && expr.isNull(); }
+
+  /// Returns true if the value is a constant held inline.
+  bool isConstant() const { return width != 0; }
+
+  Expr::Width getWidth() const { return width ? width : expr->getWidth(); }
+
+  uint64_t getZExtValue() const {
+    assert(isConstant());
+    return bits;
+  }
+
+  int64_t getSExtValue() const {
+    assert(isConstant());
+    unsigned shift = 64 - width;
+    return static_cast<int64_t>(bits << shift) >> shift;
+  }
+
+  ref<Expr> value() const {
+    if (expr.isNull() && width != 0)
+      expr = ConstantExpr::create(bits, width);
+    return expr;
+  }
 };
 } // namespace klee
 
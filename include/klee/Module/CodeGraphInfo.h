@@ -34,6 +34,9 @@ class CodeGraphInfo {
   using functionBranchesSet =
       std::unordered_map<KFunction *, KBlockMap<std::set<unsigned>>>;
 
+  using blockToRegionMap =
+      std::unordered_map<KBlock *, std::pair<KBlock *, KBlockSet>>;
+
 private:
   blockToDistanceMap blockDistance;
   blockToDistanceMap blockBackwardDistance;
@@ -50,6 +53,8 @@ private:
   functionBranchesSet functionConditionalBranches;
   functionBranchesSet functionBlocks;
 
+  blockToRegionMap blockRegions;
+
 private:
   void calculateDistance(KBlock *bb);
   void calculateBackwardDistance(KBlock *bb);
@@ -61,11 +66,20 @@ private:
   void calculateFunctionConditionalBranches(KFunction *kf);
   void calculateFunctionBlocks(KFunction *kf);
 
+  void calculateRegion(KBlock *kb);
+
 public:
   const BlockDistanceMap &getDistance(KBlock *b);
   const BlockDistanceMap &getBackwardDistance(KBlock *kb);
   bool hasCycle(KBlock *kb);
 
+  /// Returns the nearest block through which every path from `kb` passes,
+  /// if the blocks in between form an acyclic region which can only be left
+  /// through it. Returns nullptr otherwise.
+  KBlock *getRegionExit(KBlock *kb);
+  /// Returns the blocks between `kb` and its region exit, excluding both.
+  const KBlockSet &getRegion(KBlock *kb);
+
   const FunctionDistanceMap &getDistance(KFunction *kf);
   const FunctionDistanceMap &getBackwardDistance(KFunction *kf);
 
@@ -24,6 +24,7 @@ namespace klee {
 class ConstraintSet;
 class Expr;
 class SolverImpl;
+class Statistic;
 
 /// Collection of meta data that a solver can have access to. This is
 /// independent of the actual constraints but can be used as a two-way
@@ -269,6 +270,15 @@ std::unique_ptr<Solver> createSMTLIBLoggingSolver(std::unique_ptr<Solver> sm,
 /// fails.
 std::unique_ptr<Solver> createDummySolver();
 
+/// createPortfolioSolver - Create a solver which sends every query to all
+/// given solvers, each running in a forked worker, and returns the first
+/// answer. The other workers are killed.
+///
+/// \param solvers - The competing solvers, each paired with the statistic
+/// counting the queries it answered first.
+std::unique_ptr<Solver> createPortfolioSolver(
+    std::vector<std::pair<std::unique_ptr<Solver>, Statistic *>> solvers);
+
 // Create a solver based on the supplied ``CoreSolverType``.
 std::unique_ptr<Solver> createCoreSolver(CoreSolverType cst);
 
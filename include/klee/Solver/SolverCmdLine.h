@@ -67,11 +67,14 @@ enum CoreSolverType {
   DUMMY_SOLVER,
   Z3_SOLVER,
   Z3_TREE_SOLVER,
+  PORTFOLIO_SOLVER,
   NO_SOLVER
 };
 
 extern llvm::cl::opt<CoreSolverType> CoreSolverToUse;
 
+extern llvm::cl::list<CoreSolverType> PortfolioSolvers;
+
 extern llvm::cl::opt<CoreSolverType> DebugCrossCheckCoreSolverWith;
 
 extern llvm::cl::opt<bool> ProduceUnsatCore;
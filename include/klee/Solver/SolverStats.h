@@ -30,6 +30,9 @@ extern Statistic validQueriesSize;
 extern Statistic validityCoresSize;
 extern Statistic queryValidityCores;
 extern Statistic queryTime;
+extern Statistic portfolioSTPWins;
+extern Statistic portfolioZ3Wins;
+extern Statistic portfolioBitwuzlaWins;
 
 #ifdef KLEE_ARRAY_DEBUG
 extern Statistic arrayHashTime;
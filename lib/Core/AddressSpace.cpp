@@ -19,6 +19,8 @@
 
 #include "CoreStats.h"
 
+#include <atomic>
+
 namespace klee {
 llvm::cl::OptionCategory
     PointerResolvingCat("Pointer resolving options",
@@ -53,15 +55,39 @@ llvm::cl::opt<bool> UseTimestamps(
     llvm::cl::desc("Set symbolic pointers only to objects created before those "
                    "pointers were created (default=true)"),
     llvm::cl::cat(PointerResolvingCat));
+
+llvm::cl::opt<unsigned> RangeResolutionThreshold(
+    "range-resolution-threshold", llvm::cl::init(16),
+    llvm::cl::desc("Check a symbolic pointer only against the objects at the "
+                   "addresses its base may take, found with range queries, "
+                   "in address spaces with at least this many objects "
+                   "(0=off, default=16)"),
+    llvm::cl::cat(PointerResolvingCat));
 } // namespace klee
 
 using namespace klee;
 
 ///
 
+uint64_t AddressSpace::newEpoch() {
+  static std::atomic<uint64_t> lastEpoch(0);
+  return ++lastEpoch;
+}
+
+static bool isSymbolicObject(const MemoryObject *mo) {
+  return !isa<ConstantExpr>(mo->getBaseExpr()) ||
+         !isa<ConstantExpr>(mo->getSizeExpr());
+}
+
 void AddressSpace::bindObject(const MemoryObject *mo, ObjectState *os) {
   assert(os->copyOnWriteOwner == 0 && "object already has owner");
   os->copyOnWriteOwner = cowKey;
+  // Copies of written objects are bound over the originals, which leaves the
+  // set of objects as it was
+  if (!objects.lookup(mo)) {
+    advanceEpoch();
+    symbolicObjects += isSymbolicObject(mo);
+  }
   objects = objects.replace(std::make_pair(mo, os));
 }
 
@@ -71,6 +97,10 @@ void AddressSpace::bindObject(const MemoryObject *mo, const ObjectState *os) {
 }
 
 void AddressSpace::unbindObject(const MemoryObject *mo) {
+  if (objects.lookup(mo)) {
+    advanceEpoch();
+    symbolicObjects -= isSymbolicObject(mo);
+  }
   objects = objects.remove(mo);
 }
 
@@ -172,6 +202,121 @@ bool AddressSpace::resolveOneIfUnique(ExecutionState &state,
   return true;
 }
 
+namespace {
+/// Walk the objects yielded by `next`, which are ever further from a feasible
+/// value of a pointer base, and keep in `walked` those the base may reach.
+/// As `mayReach` only turns from true to false along the walk, the walk
+/// gallops and then bisects, so the number of queries is logarithmic in the
+/// number of reachable objects.
+///
+/// \return false iff a query failed.
+template <typename Next, typename MayReach>
+bool gallopObjects(Next next, MayReach mayReach, ResolutionList &walked) {
+  size_t reachable = 0, unreachable = 0;
+  for (size_t probe = 0;; probe = 2 * probe + 1) {
+    for (ObjectPair op; walked.size() <= probe && (op = next()).first;)
+      walked.push_back(op);
+    if (probe >= walked.size()) {
+      unreachable = walked.size();
+      break;
+    }
+    bool result;
+    if (!mayReach(walked[probe].first, result))
+      return false;
+    if (!result) {
+      unreachable = probe;
+      break;
+    }
+    reachable = probe + 1;
+  }
+
+  while (reachable < unreachable) {
+    size_t middle = reachable + (unreachable - reachable) / 2;
+    bool result;
+    if (!mayReach(walked[middle].first, result))
+      return false;
+    if (result) {
+      reachable = middle + 1;
+    } else {
+      unreachable = middle;
+    }
+  }
+  walked.resize(reachable);
+  return true;
+}
+} // namespace
+
+bool AddressSpace::getCandidates(ExecutionState &state, TimingSolver *solver,
+                                 ref<PointerExpr> p,
+                                 ref<ConstantPointerExpr> cex,
+                                 ResolutionList &candidates) const {
+  unsigned seen = 0;
+  for (auto oi = objects.begin(), oe = objects.end();
+       oi != oe && seen < RangeResolutionThreshold; ++oi)
+    ++seen;
+  if (RangeResolutionThreshold == 0 || seen < RangeResolutionThreshold) {
+    for (const auto &object : objects)
+      candidates.emplace_back(object.first, object.second.get());
+    return true;
+  }
+
+  if (!cex &&
+      !solver->getValue(state.constraints.cs(), p, cex, state.queryMetaData))
+    return false;
+
+  // Objects with a concrete address are ordered by it and a pointer may only
+  // point to an object at the address its base takes, so the candidates are
+  // those in the range of the base around the one in `cex`.
+  ref<Expr> base = p->getBase();
+  MemoryObject hack(cex->getConstantBase()->getZExtValue());
+  MemoryMap::iterator oe = objects.end();
+
+  ResolutionList below;
+  MemoryMap::iterator down = objects.lower_bound(&hack);
+  bool exhausted = false;
+  auto nextBelow = [&]() {
+    while (!exhausted) {
+      --down;
+      if (down == oe) {
+        exhausted = true;
+      } else if (down->first->address) {
+        return ObjectPair(down->first, down->second.get());
+      }
+    }
+    return ObjectPair(nullptr, nullptr);
+  };
+  auto mayReachBelow = [&](const MemoryObject *mo, bool &result) {
+    return solver->mayBeTrue(state.constraints.cs(),
+                             UleExpr::create(base, mo->getBaseExpr()), result,
+                             state.queryMetaData);
+  };
+  if (!gallopObjects(nextBelow, mayReachBelow, below))
+    return false;
+  candidates.insert(candidates.end(), below.rbegin(), below.rend());
+
+  MemoryMap::iterator up = objects.lower_bound(&hack);
+  auto nextAbove = [&]() {
+    if (up == oe || !up->first->address)
+      return ObjectPair(nullptr, nullptr);
+    ObjectPair op(up->first, up->second.get());
+    ++up;
+    return op;
+  };
+  auto mayReachAbove = [&](const MemoryObject *mo, bool &result) {
+    return solver->mayBeTrue(state.constraints.cs(),
+                             UgeExpr::create(base, mo->getBaseExpr()), result,
+                             state.queryMetaData);
+  };
+  if (!gallopObjects(nextAbove, mayReachAbove, candidates))
+    return false;
+
+  // Objects with a symbolic address come after all the others
+  MemoryObject last(UINT64_MAX);
+  for (MemoryMap::iterator oi = objects.upper_bound(&last); oi != oe; ++oi)
+    candidates.emplace_back(oi->first, oi->second.get());
+  return true;
+}
+
 class ResolvePredicate {
   bool useTimestamps;
   bool skipNotSymbolicObjects;
@@ -257,10 +402,13 @@ bool AddressSpace::resolveOne(ExecutionState &state, TimingSolver *solver,
 
   // didn't work, now we have to search
 
-  for (MemoryMap::iterator oi = objects.begin(), oe = objects.end(); oi != oe;
-       ++oi) {
-    const auto &mo = oi->first;
-    if (!predicate(mo, oi->second.get())) {
+  ResolutionList candidates;
+  if (!getCandidates(state, solver, address, addressCex, candidates))
+    return false;
+
+  for (const auto &op : candidates) {
+    const MemoryObject *mo = op.first;
+    if (!predicate(mo, op.second)) {
       continue;
     }
 
@@ -274,7 +422,7 @@ bool AddressSpace::resolveOne(ExecutionState &state, TimingSolver *solver,
                            state.queryMetaData))
       return false;
     if (mayBeTrue) {
-      result = {oi->first, oi->second.get()};
+      result = op;
       success = true;
       return true;
     }
@@ -353,23 +501,18 @@ bool AddressSpace::resolve(ExecutionState &state, TimingSolver *solver,
   // see if we need to keep searching up/down, in bad cases?
   // maybe we don't care?
 
-  // XXX we really just need a smart place to start (although
-  // if its a known solution then the code below is guaranteed
-  // to hit the fast path with exactly 2 queries). we could also
-  // just get this by inspection of the expr.
+  ResolutionList candidates;
+  if (!getCandidates(state, solver, p, nullptr, candidates))
+    return true;
 
-  for (MemoryMap::iterator oi = objects.begin(), oe = objects.end(); oi != oe;
-       ++oi) {
-    const MemoryObject *mo = oi->first;
-    if (!predicate(mo, oi->second.get())) {
+  for (const auto &op : candidates) {
+    if (!predicate(op.first, op.second)) {
       continue;
     }
 
     if (timeout && timeout < timer.delta())
       return true;
 
-    auto op = std::make_pair<>(mo, oi->second.get());
-
     int incomplete =
         checkPointerInObject(state, solver, p, op, rl, maxResolutions);
     if (incomplete != 2)
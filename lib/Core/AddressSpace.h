@@ -45,6 +45,12 @@ private:
   /// Epoch counter used to control ownership of objects.
   mutable unsigned cowKey;
 
+  /// Identifies the set of bound objects, see getEpoch()
+  uint64_t epoch;
+
+  /// Number of bound objects with a symbolic address or size
+  unsigned symbolicObjects = 0;
+
   /// Unsupported, use copy constructor
   AddressSpace &operator=(const AddressSpace &);
 
@@ -59,6 +65,16 @@ private:
                            ref<PointerExpr> p, const ObjectPair &op,
                            ResolutionList &rl, unsigned maxResolutions) const;
 
+  /// Collect in address order the objects pointer `p` may point to
+  /// according to the addresses its base may take. `cex` is a feasible
+  /// value of `p`, or null to have one computed. Objects with a symbolic
+  /// address are always collected.
+  ///
+  /// \return false iff a query failed.
+  bool getCandidates(ExecutionState &state, TimingSolver *solver,
+                     ref<PointerExpr> p, ref<ConstantPointerExpr> cex,
+                     ResolutionList &candidates) const;
+
 public:
   /// The MemoryObject -> ObjectState map that constitutes the
   /// address space.
@@ -76,11 +92,28 @@ public:
 
   mutable bool complete = false;
 
-  AddressSpace() : cowKey(1) {}
+  AddressSpace() : cowKey(1), epoch(newEpoch()) {}
   AddressSpace(const AddressSpace &b)
-      : cowKey(++b.cowKey), objects(b.objects), complete(b.complete) {}
+      : cowKey(++b.cowKey), epoch(b.epoch),
+        symbolicObjects(b.symbolicObjects), objects(b.objects),
+        complete(b.complete) {}
   ~AddressSpace() {}
 
+  /// Returns a number unique to the objects bound in this address space.
+  /// Copies share the epoch of the original until an object is bound or
+  /// unbound in them, so address spaces with the same epoch hold the same
+  /// memory objects, although maybe in different states.
+  uint64_t getEpoch() const { return epoch; }
+
+  /// Gives this address space an epoch of its own, as when its objects
+  /// change
+  void advanceEpoch() { epoch = newEpoch(); }
+
+  static uint64_t newEpoch();
+
+  /// Returns true iff an object with a symbolic address or size is bound
+  bool hasSymbolicObjects() const { return symbolicObjects != 0; }
+
   /// Resolve address to an ObjectPair in result.
   /// \return true iff an object was found.
   bool resolveOne(ref<ConstantPointerExpr> address, ObjectPair &result) const;
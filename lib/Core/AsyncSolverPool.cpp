@@ -0,0 +1,145 @@
+//===-- AsyncSolverPool.cpp -----------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AsyncSolverPool.h"
+
+#include "CoreStats.h"
+#include "ExecutionState.h"
+#include "TimingSolver.h"
+
+#include "klee/Support/ErrorHandling.h"
+
+#include "llvm/Support/Errno.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace klee;
+
+AsyncSolverPool::~AsyncSolverPool() {
+  while (!pending.empty())
+    cancel(pending.back().state);
+}
+
+bool AsyncSolverPool::isPending(const ExecutionState *state) const {
+  return std::any_of(pending.begin(), pending.end(),
+                     [state](const Query &q) { return q.state == state; });
+}
+
+bool AsyncSolverPool::submit(ExecutionState &state, ref<Expr> condition,
+                             time::Span timeout) {
+  assert(hasCapacity() && !isPending(&state));
+  int fds[2];
+  if (pipe(fds) == -1) {
+    klee_warning_once(0, "pipe failed (for async solver) - %s",
+                      llvm::sys::StrError(errno).c_str());
+    return false;
+  }
+
+  fflush(stdout);
+  fflush(stderr);
+
+  pid_t pid = fork();
+  // - error
+  if (pid == -1) {
+    klee_warning_once(0, "fork failed (for async solver) - %s",
+                      llvm::sys::StrError(errno).c_str());
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  // - child (solver)
+  if (pid == 0) {
+    close(fds[0]);
+    solver->setTimeout(timeout);
+    PartialValidity validity = PartialValidity::None;
+    bool success = solver->evaluate(state.constraints.cs(), condition,
+                                    validity, state.queryMetaData);
+    signed char answer[2] = {static_cast<signed char>(success),
+                             static_cast<signed char>(validity)};
+    ssize_t written;
+    do {
+      written = write(fds[1], answer, sizeof(answer));
+    } while (written < 0 && errno == EINTR);
+    _exit(written == sizeof(answer) ? 0 : 1);
+  }
+  // - parent
+  close(fds[1]);
+  pending.push_back({&state, condition, pid, fds[0]});
+  ++stats::asyncQueries;
+  return true;
+}
+
+void AsyncSolverPool::reap(std::vector<Query>::iterator it, Result &result) {
+  signed char answer[2];
+  ssize_t received;
+  do {
+    received = read(it->fd, answer, sizeof(answer));
+  } while (received < 0 && errno == EINTR);
+  close(it->fd);
+
+  int status;
+  pid_t res;
+  do {
+    res = waitpid(it->pid, &status, 0);
+  } while (res < 0 && errno == EINTR);
+
+  result.state = it->state;
+  result.condition = it->condition;
+  result.success = received == sizeof(answer) && answer[0];
+  result.validity = result.success ? static_cast<PartialValidity>(answer[1])
+                                   : PartialValidity::None;
+  pending.erase(it);
+}
+
+bool AsyncSolverPool::poll(Result &result, bool wait) {
+  if (pending.empty())
+    return false;
+
+  std::vector<struct pollfd> fds;
+  fds.reserve(pending.size());
+  for (const auto &q : pending)
+    fds.push_back({q.fd, POLLIN, 0});
+
+  int ready;
+  do {
+    ready = ::poll(fds.data(), fds.size(), wait ? -1 : 0);
+  } while (ready < 0 && errno == EINTR);
+  if (ready <= 0)
+    return false;
+
+  for (size_t i = 0; i < fds.size(); ++i) {
+    if (fds[i].revents) {
+      reap(pending.begin() + i, result);
+      return true;
+    }
+  }
+  return false;
+}
+
+void AsyncSolverPool::cancel(const ExecutionState *state) {
+  auto it = std::find_if(pending.begin(), pending.end(),
+                         [state](const Query &q) { return q.state == state; });
+  if (it == pending.end())
+    return;
+
+  kill(it->pid, SIGKILL);
+  close(it->fd);
+  int status;
+  pid_t res;
+  do {
+    res = waitpid(it->pid, &status, 0);
+  } while (res < 0 && errno == EINTR);
+  pending.erase(it);
+}
@@ -0,0 +1,77 @@
+//===-- AsyncSolverPool.h ---------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_ASYNCSOLVERPOOL_H
+#define KLEE_ASYNCSOLVERPOOL_H
+
+#include "klee/ADT/Ref.h"
+#include "klee/Expr/Expr.h"
+#include "klee/Solver/SolverUtil.h"
+#include "klee/System/Time.h"
+
+#include <sys/types.h>
+
+#include <vector>
+
+namespace klee {
+class ExecutionState;
+class TimingSolver;
+
+/// Runs branch feasibility queries in the background while the interpreter
+/// keeps stepping other states. Every query is solved by a forked copy of the
+/// process, so the solver chain and the expression DAG are never shared
+/// between threads. The answer is passed back through a pipe.
+class AsyncSolverPool {
+public:
+  struct Result {
+    ExecutionState *state = nullptr;
+    ref<Expr> condition;
+    PartialValidity validity = PartialValidity::None;
+    bool success = false;
+  };
+
+private:
+  struct Query {
+    ExecutionState *state;
+    ref<Expr> condition;
+    pid_t pid;
+    int fd;
+  };
+
+  TimingSolver *solver;
+  unsigned workers;
+  std::vector<Query> pending;
+
+  void reap(std::vector<Query>::iterator it, Result &result);
+
+public:
+  AsyncSolverPool(TimingSolver *solver, unsigned workers)
+      : solver(solver), workers(workers) {}
+  ~AsyncSolverPool();
+
+  bool hasCapacity() const { return pending.size() < workers; }
+  bool empty() const { return pending.empty(); }
+  bool isPending(const ExecutionState *state) const;
+
+  /// Starts evaluating `condition` under the constraints of `state` in a
+  /// background worker. Returns false if no worker could be started.
+  bool submit(ExecutionState &state, ref<Expr> condition, time::Span timeout);
+
+  /// Retrieves the answer of some finished query. If `wait` is set, blocks
+  /// until one of the pending queries finishes. Returns false if no answer is
+  /// available.
+  bool poll(Result &result, bool wait);
+
+  /// Drops the query of a state which was terminated while waiting.
+  void cancel(const ExecutionState *state);
+};
+
+} // namespace klee
+
+#endif /* KLEE_ASYNCSOLVERPOOL_H */
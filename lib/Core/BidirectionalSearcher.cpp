@@ -6,20 +6,56 @@
 namespace klee {
 
 ref<SearcherAction> ForwardOnlySearcher::selectAction() {
+  AsyncSolverPool::Result result;
+  // Block on the pool only if there is nothing else to step
+  if (solverPool && solverPool->poll(result, searcher->empty())) {
+    resume(*result.state);
+    return new ResumeAction(result.state, result.condition, result.validity,
+                            result.success);
+  }
   return new ForwardAction(&searcher->selectState());
 }
 
-bool ForwardOnlySearcher::empty() { return searcher->empty(); }
+bool ForwardOnlySearcher::empty() {
+  return searcher->empty() && (!solverPool || solverPool->empty());
+}
 
 void ForwardOnlySearcher::update(ref<ObjectManager::Event> e) {
   if (auto statesEvent = dyn_cast<ObjectManager::States>(e)) {
-    searcher->update(statesEvent->modified, statesEvent->added,
-                     statesEvent->removed);
+    if (suspended.empty()) {
+      searcher->update(statesEvent->modified, statesEvent->added,
+                       statesEvent->removed);
+      return;
+    }
+
+    // Suspended states are unknown to the searcher
+    std::vector<ExecutionState *> removed;
+    for (auto state : statesEvent->removed) {
+      if (suspended.erase(state)) {
+        if (solverPool && solverPool->isPending(state))
+          solverPool->cancel(state);
+      } else {
+        removed.push_back(state);
+      }
+    }
+    searcher->update(statesEvent->modified, statesEvent->added, removed);
   }
 }
 
-ForwardOnlySearcher::ForwardOnlySearcher(Searcher *_searcher) {
+void ForwardOnlySearcher::suspend(ExecutionState &state) {
+  searcher->update(nullptr, {}, {&state});
+  suspended.insert(&state);
+}
+
+void ForwardOnlySearcher::resume(ExecutionState &state) {
+  suspended.erase(&state);
+  searcher->update(nullptr, {&state}, {});
+}
+
+ForwardOnlySearcher::ForwardOnlySearcher(Searcher *_searcher,
+                                         AsyncSolverPool *_solverPool) {
   searcher = _searcher;
+  solverPool = _solverPool;
 }
 
 ForwardOnlySearcher::~ForwardOnlySearcher() { delete searcher; }
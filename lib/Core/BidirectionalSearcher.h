@@ -1,16 +1,21 @@
 #ifndef KLEE_BIDIRECTIONALSEARCHER_H
 #define KLEE_BIDIRECTIONALSEARCHER_H
 
+#include "AsyncSolverPool.h"
 #include "ObjectManager.h"
 #include "Searcher.h"
 #include "SearcherUtil.h"
 
+#include <unordered_set>
+
 namespace klee {
 
 class IBidirectionalSearcher : public Subscriber {
 public:
   virtual ref<SearcherAction> selectAction() = 0;
   virtual bool empty() = 0;
+  virtual void suspend(ExecutionState &state) = 0;
+  virtual void resume(ExecutionState &state) = 0;
   virtual ~IBidirectionalSearcher() {}
 };
 
@@ -19,11 +24,21 @@ public:
   ref<SearcherAction> selectAction() override;
   void update(ref<ObjectManager::Event>) override;
   bool empty() override;
-  explicit ForwardOnlySearcher(Searcher *searcher);
+  explicit ForwardOnlySearcher(Searcher *searcher,
+                               AsyncSolverPool *solverPool = nullptr);
   ~ForwardOnlySearcher() override;
 
+  /// Hides a state from the underlying searcher, e.g. until its pending
+  /// query in the solver pool is answered.
+  void suspend(ExecutionState &state) override;
+  /// Hands a suspended state back to the underlying searcher.
+  void resume(ExecutionState &state) override;
+
 private:
   Searcher *searcher;
+  AsyncSolverPool *solverPool;
+  /// States hidden from the underlying searcher
+  std::unordered_set<ExecutionState *> suspended;
 };
 
 } // namespace klee
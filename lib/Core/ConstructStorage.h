@@ -24,6 +24,23 @@ enum class MemoryType { Fixed, Dynamic, Persistent, Mixed };
 extern llvm::cl::opt<MemoryType> MemoryBackend;
 extern llvm::cl::opt<unsigned long> MaxFixedSizeStructureSize;
 
+/// Storage for `size` values, split into pages shared between copies if it
+/// spans more than one page
+template <typename ValueType, typename Eq = std::equal_to<ValueType>>
+SparseStorage<ValueType, Eq> *
+constructArrayStorage(size_t size, const ValueType &defaultValue) {
+  if (size > PagedArrayAdapter<ValueType, Eq>::PageSize) {
+    return new SparseStorageImpl<ValueType, Eq,
+                                 PagedArrayAdapter<ValueType, Eq>>(
+        defaultValue,
+        typename PagedArrayAdapter<ValueType, Eq>::constructor(size));
+  }
+  return new SparseStorageImpl<ValueType, Eq,
+                               SparseArrayAdapter<ValueType, Eq>>(
+      defaultValue,
+      typename SparseArrayAdapter<ValueType, Eq>::constructor(size));
+}
+
 template <typename ValueType, typename Eq = std::equal_to<ValueType>>
 SparseStorage<ValueType, Eq> *
 constructStorage(ref<Expr> size, const ValueType &defaultValue,
@@ -32,10 +49,8 @@ constructStorage(ref<Expr> size, const ValueType &defaultValue,
   case klee::MemoryType::Mixed: {
     if (auto constSize = dyn_cast<ConstantExpr>(size);
         constSize && constSize->getZExtValue() <= treshold) {
-      return new SparseStorageImpl<ValueType, Eq,
-                                   SparseArrayAdapter<ValueType, Eq>>(
-          defaultValue, typename SparseArrayAdapter<ValueType, Eq>::constructor(
-                            constSize->getZExtValue()));
+      return constructArrayStorage<ValueType, Eq>(constSize->getZExtValue(),
+                                                  defaultValue);
     } else {
       return new SparseStorageImpl<ValueType, Eq,
                                    PersistenUnorderedMapAdapder<ValueType, Eq>>(
@@ -44,19 +59,15 @@ constructStorage(ref<Expr> size, const ValueType &defaultValue,
   }
   case klee::MemoryType::Fixed: {
     if (auto constSize = dyn_cast<ConstantExpr>(size); constSize) {
-      return new SparseStorageImpl<ValueType, Eq,
-                                   SparseArrayAdapter<ValueType, Eq>>(
-          defaultValue, typename SparseArrayAdapter<ValueType, Eq>::constructor(
-                            constSize->getZExtValue()));
+      return constructArrayStorage<ValueType, Eq>(constSize->getZExtValue(),
+                                                  defaultValue);
     } else {
       return new SparseStorageImpl<ValueType, Eq,
-                                   UnorderedMapAdapder<ValueType, Eq>>(
-          defaultValue);
+                                   DensityAdapter<ValueType, Eq>>(defaultValue);
     }
   }
   case klee::MemoryType::Dynamic: {
-    return new SparseStorageImpl<ValueType, Eq,
-                                 UnorderedMapAdapder<ValueType, Eq>>(
+    return new SparseStorageImpl<ValueType, Eq, DensityAdapter<ValueType, Eq>>(
         defaultValue);
   }
   case klee::MemoryType::Persistent: {
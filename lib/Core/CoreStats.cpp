@@ -13,12 +13,25 @@
 using namespace klee;
 
 Statistic stats::allocations("Allocations", "Alloc");
+Statistic stats::asyncQueries("AsyncQueries", "AsyncQ");
+Statistic stats::bulkMemoryCalls("BulkMemoryCalls", "BulkM");
 Statistic stats::coveredInstructions("CoveredInstructions", "Icov");
 Statistic stats::externalCalls("ExternalCalls", "ExtC");
 Statistic stats::falseBranches("FalseBranches", "Bf");
 Statistic stats::forkTime("ForkTime", "Ftime");
 Statistic stats::forks("Forks", "Forks");
 Statistic stats::inhibitedForks("InhibitedForks", "InhibForks");
+Statistic stats::lazyForks("LazyForks", "LazyF");
+Statistic stats::lazyForksInfeasible("LazyForksInfeasible", "LazyFinf");
+Statistic stats::mergedStates("MergedStates", "Merged");
+Statistic stats::jitCompiledBlocks("JitCompiledBlocks", "JitC");
+Statistic stats::jitExecutedBlocks("JitExecutedBlocks", "JitE");
+Statistic stats::spilledStates("SpilledStates", "SpillS");
+Statistic stats::reloadedStates("ReloadedStates", "SpillR");
+Statistic stats::reusedAllocations("ReusedAllocations", "ReuseA");
+Statistic stats::memoryObjectSlabBytes("MemoryObjectSlabBytes", "MOSlab");
+Statistic stats::resolutionCacheHits("ResolutionCacheHits", "RChits");
+Statistic stats::resolutionCacheMisses("ResolutionCacheMisses", "RCmisses");
 Statistic stats::instructionRealTime("InstructionRealTimes", "Ireal");
 Statistic stats::instructionTime("InstructionTimes", "Itime");
 Statistic stats::instructions("Instructions", "I");
@@ -26,6 +39,7 @@ Statistic stats::minDistToReturn("MinDistToReturn", "Rdist");
 Statistic stats::minDistToUncovered("MinDistToUncovered", "UCdist");
 Statistic stats::resolveTime("ResolveTime", "Rtime");
 Statistic stats::solverTime("SolverTime", "Stime");
+Statistic stats::addConstraintTime("AddConstraintTime", "ACtime");
 Statistic stats::states("States", "States");
 Statistic stats::trueBranches("TrueBranches", "Bt");
 Statistic stats::uncoveredInstructions("UncoveredInstructions", "Iuncov");
@@ -29,6 +29,17 @@ extern Statistic falseBranches;
 extern Statistic forkTime;
 extern Statistic solverTime;
 
+/// Time spent adding path constraints, including rewriting the constraints
+/// they share arrays with (see --rewrite-equalities).
+extern Statistic addConstraintTime;
+
+/// The number of branch queries handed to background solver workers.
+extern Statistic asyncQueries;
+
+/// Number of calls to memory functions run without executing their bodies
+/// (see --bulk-memory-functions).
+extern Statistic bulkMemoryCalls;
+
 /// The number of external calls.
 extern Statistic externalCalls;
 
@@ -38,6 +49,41 @@ extern Statistic forks;
 /// Number of inhibited forks.
 extern Statistic inhibitedForks;
 
+/// Number of forks whose feasibility check was deferred (see --lazy-forks).
+extern Statistic lazyForks;
+
+/// Number of lazily forked states dropped because their branch was
+/// infeasible.
+extern Statistic lazyForksInfeasible;
+
+/// Number of states merged into another state (see --merge-regions).
+extern Statistic mergedStates;
+
+/// Number of basic blocks compiled to native code (see
+/// --jit-concrete-blocks).
+extern Statistic jitCompiledBlocks;
+
+/// Number of basic blocks run natively.
+extern Statistic jitExecutedBlocks;
+
+/// Number of states written to the spill file (see --spill-states).
+extern Statistic spilledStates;
+
+/// Number of spilled states read back.
+extern Statistic reloadedStates;
+
+/// Number of deterministic allocations placed in the space of freed objects
+/// (see --allocate-determ-quarantine).
+extern Statistic reusedAllocations;
+
+/// Bytes held in slabs for memory objects, which is their peak footprint.
+extern Statistic memoryObjectSlabBytes;
+
+/// Number of symbolic pointer resolutions found in and missing from the
+/// resolution cache shared by all states (see --resolution-cache-size).
+extern Statistic resolutionCacheHits;
+extern Statistic resolutionCacheMisses;
+
 /// Number of states, this is a "fake" statistic used by istats, it
 /// isn't normally up-to-date.
 extern Statistic states;
@@ -10,12 +10,14 @@
 #include "ExecutionState.h"
 
 #include "ConstructStorage.h"
+#include "CoreStats.h"
 #include "Memory.h"
 
 #include "klee/Expr/Expr.h"
 #include "klee/Module/Cell.h"
 #include "klee/Module/KInstruction.h"
 #include "klee/Module/KModule.h"
+#include "klee/Statistics/TimerStatIncrementer.h"
 #include "klee/Support/Casting.h"
 #include "klee/Support/OptionCategories.h"
 
@@ -92,18 +94,32 @@ void ExecutionStack::popFrame() {
   stackSize -= kf->getNumRegisters();
 }
 
+size_t ExecutionStack::getMemoryUsage() const {
+  size_t usage = 0;
+  for (const auto &frame : valueStack_) {
+    usage += frame.locals.size() * sizeof(Cell) / frame.locals.sharers();
+    usage += frame.allocas.size() * sizeof(ref<const MemoryObject>);
+  }
+  usage += valueStack_.capacity() * sizeof(StackFrame) +
+           callStack_.capacity() * sizeof(CallStackFrame) +
+           infoStack_.capacity() * sizeof(InfoStackFrame) +
+           uniqueFrames_.capacity() * sizeof(CallStackFrame);
+  return usage;
+}
+
 bool CallStackFrame::equals(const CallStackFrame &other) const {
   return kf == other.kf && caller == other.caller;
 }
 
-StackFrame::StackFrame(KFunction *kf) : kf(kf), varargs(nullptr) {
-  locals.reset(constructStorage<Cell>(kf->getNumRegisters()));
-}
+FrameLocals::FrameLocals(size_t size) : storage(constructStorage<Cell>(size)) {}
+
+void FrameLocals::clear() { storage.reset(constructStorage<Cell>(size())); }
+
+StackFrame::StackFrame(KFunction *kf)
+    : kf(kf), locals(kf->getNumRegisters()), varargs(nullptr) {}
 
 StackFrame::StackFrame(const StackFrame &s)
-    : kf(s.kf), allocas(s.allocas), varargs(s.varargs) {
-  locals.reset(s.locals->clone());
-}
+    : kf(s.kf), allocas(s.allocas), locals(s.locals), varargs(s.varargs) {}
 
 StackFrame::~StackFrame() {}
 
@@ -168,7 +184,8 @@ ExecutionState::ExecutionState(const ExecutionState &state)
                                ? state.unwindingInformation->clone()
                                : nullptr),
       coveredNew(state.coveredNew), coveredNewError(state.coveredNewError),
-      forkDisabled(state.forkDisabled), returnValue(state.returnValue),
+      forkDisabled(state.forkDisabled), mergeGroup(state.mergeGroup),
+      returnValue(state.returnValue),
       gepExprBases(state.gepExprBases), multiplexKF(state.multiplexKF),
       prevTargets_(state.prevTargets_), targets_(state.targets_),
       prevHistory_(state.prevHistory_), history_(state.history_),
@@ -181,6 +198,8 @@ ExecutionState *ExecutionState::branch() {
 
   auto *falseState = new ExecutionState(*this);
   falseState->setID();
+  if (mergeGroup)
+    ++mergeGroup->live;
   falseState->coveredLines.clear();
   falseState->prevTargets_ = falseState->targets_;
   falseState->prevHistory_ = falseState->history_;
@@ -188,6 +207,93 @@ ExecutionState *ExecutionState::branch() {
   return falseState;
 }
 
+static bool sameCell(const Cell &a, const Cell &b) {
+  // A register which is unset on one side is not used after the merge
+  if (a.isNull() || b.isNull())
+    return true;
+  if (a.isConstant() && b.isConstant())
+    return a.getWidth() == b.getWidth() &&
+           a.getZExtValue() == b.getZExtValue();
+  return a.value() == b.value();
+}
+
+bool ExecutionState::merge(const ExecutionState &b) {
+  if (pc != b.pc || stack.size() != b.stack.size() ||
+      stack.callStack() != b.stack.callStack())
+    return false;
+  if (symbolics.size() != b.symbolics.size())
+    return false;
+  if (isTargeted() != b.isTargeted() || targets() != b.targets() ||
+      history() != b.history())
+    return false;
+  if (!constraints.cs().symcretes().empty() ||
+      !b.constraints.cs().symcretes().empty())
+    return false;
+
+  auto &frames = stack.valueStack();
+  auto &bFrames = b.stack.valueStack();
+  for (unsigned i = 0; i < frames.size(); ++i) {
+    for (unsigned reg = 0; reg < frames[i].locals.size(); ++reg) {
+      const Cell &av = frames[i].locals.at(reg);
+      const Cell &bv = bFrames[i].locals.at(reg);
+      if (!sameCell(av, bv) &&
+          isa<PointerExpr>(av.value()) != isa<PointerExpr>(bv.value()))
+        return false;
+    }
+  }
+
+  if (addressSpace.objects.size() != b.addressSpace.objects.size())
+    return false;
+  std::vector<std::pair<const MemoryObject *, const ObjectState *>> differing;
+  for (auto ai = addressSpace.objects.begin(),
+            bi = b.addressSpace.objects.begin(),
+            ae = addressSpace.objects.end();
+       ai != ae; ++ai, ++bi) {
+    if (ai->first != bi->first)
+      return false;
+    if (ai->second.get() == bi->second.get())
+      continue;
+    if (!isa<ConstantExpr>(ai->second->getObject()->getSizeExpr()))
+      return false;
+    differing.emplace_back(ai->first, bi->second.get());
+  }
+
+  ref<Expr> inA;
+  constraints = PathConstraints::join(constraints, b.constraints, inA);
+
+  for (unsigned i = 0; i < frames.size(); ++i) {
+    for (unsigned reg = 0; reg < frames[i].locals.size(); ++reg) {
+      const Cell &av = frames[i].locals.at(reg);
+      const Cell &bv = bFrames[i].locals.at(reg);
+      if (av.isNull() && !bv.isNull())
+        frames[i].locals.set(reg, bv);
+      else if (!sameCell(av, bv))
+        frames[i].locals.set(
+            reg, Cell(SelectExpr::create(inA, av.value(), bv.value())));
+    }
+  }
+
+  for (auto &object : differing) {
+    const ObjectState *os = addressSpace.findObject(object.first).second;
+    addressSpace.getWriteable(object.first, os)->merge(inA, *object.second);
+  }
+
+  depth = std::min(depth, b.depth);
+  for (const auto &lines : b.coveredLines)
+    coveredLines[lines.first].insert(lines.second.begin(), lines.second.end());
+  for (const auto &resolution : b.resolvedPointers) {
+    auto objects = resolvedPointers[resolution.first].second;
+    objects.insert(resolution.second.begin(), resolution.second.end());
+    resolvedPointers.replace({resolution.first, objects});
+  }
+  for (const auto &base : b.gepExprBases)
+    gepExprBases.insert(base);
+  for (const auto &name : b.arrayNames)
+    arrayNames.replace(
+        {name.first, std::max(arrayNames[name.first].second, name.second)});
+  return true;
+}
+
 bool ExecutionState::inSymbolics(const MemoryObject *mo) const {
   for (const auto &symbolic : symbolics) {
     if (mo->id == symbolic.memoryObject->id) {
@@ -249,6 +355,9 @@ void ExecutionState::popFrame() {
 
 void ExecutionState::addSymbolic(const MemoryObject *mo, const Array *array) {
   symbolics.push_back({mo, array});
+  // Pointers may resolve to symbolic objects only or to objects created
+  // before their base, which is found through the symbolics
+  addressSpace.advanceEpoch();
 }
 
 ref<const MemoryObject>
@@ -282,13 +391,18 @@ bool ExecutionState::getBase(
 }
 
 void ExecutionState::removePointerResolutions(const MemoryObject *mo) {
-  for (auto resolution = begin(resolvedPointers);
-       resolution != end(resolvedPointers);) {
-    resolution->second.erase(mo);
-    if (resolution->second.size() == 0) {
-      resolution = resolvedPointers.erase(resolution);
+  std::vector<std::pair<ref<Expr>, std::set<ref<const MemoryObject>>>> updated;
+  for (const auto &resolution : resolvedPointers) {
+    if (resolution.second.count(mo)) {
+      updated.push_back(resolution);
+      updated.back().second.erase(mo);
+    }
+  }
+  for (const auto &resolution : updated) {
+    if (resolution.second.empty()) {
+      resolvedPointers.remove(resolution.first);
     } else {
-      ++resolution;
+      resolvedPointers.replace(resolution);
     }
   }
 
@@ -307,7 +421,7 @@ void ExecutionState::removePointerResolutions(ref<PointerExpr> address,
                                               unsigned size) {
   ref<Expr> base = address->getBase();
   if (!isa<ConstantExpr>(base)) {
-    resolvedPointers[base].clear();
+    resolvedPointers.replace({base, {}});
     resolvedSubobjects[MemorySubobject(address, size)].clear();
   }
 }
@@ -318,7 +432,9 @@ void ExecutionState::addPointerResolution(ref<PointerExpr> address,
                                           unsigned size) {
   ref<Expr> base = address->getBase();
   if (!isa<ConstantExpr>(base)) {
-    resolvedPointers[base].insert(mo);
+    auto objects = resolvedPointers[base].second;
+    objects.insert(mo);
+    resolvedPointers.replace({base, objects});
     resolvedSubobjects[MemorySubobject(address, size)].insert(mo);
   }
 }
@@ -329,7 +445,9 @@ void ExecutionState::addUniquePointerResolution(ref<PointerExpr> address,
   ref<Expr> base = address->getBase();
   if (!isa<ConstantExpr>(base)) {
     removePointerResolutions(address, size);
-    resolvedPointers[base].insert(mo);
+    auto objects = resolvedPointers[base].second;
+    objects.insert(mo);
+    resolvedPointers.replace({base, objects});
     resolvedSubobjects[MemorySubobject(address, size)].insert(mo);
   }
 }
@@ -376,7 +494,7 @@ void ExecutionState::dumpStack(llvm::raw_ostream &out) const {
       if (ai->hasName())
         out << ai->getName().str() << "=";
 
-      ref<Expr> value = sf.locals->at(csf.kf->getArgRegister(index++)).value;
+      ref<Expr> value = sf.locals.at(csf.kf->getArgRegister(index++)).value();
       if (isa_and_nonnull<ConstantExpr>(value)) {
         out << value;
       } else if (isa_and_nonnull<ConstantPointerExpr>(value)) {
@@ -395,6 +513,7 @@ void ExecutionState::dumpStack(llvm::raw_ostream &out) const {
 }
 
 void ExecutionState::addConstraint(ref<Expr> e) {
+  TimerStatIncrementer timer(stats::addConstraintTime);
   constraints.addConstraint(e);
 }
 
@@ -434,7 +553,7 @@ void ExecutionState::increaseLevel() {
 }
 
 bool ExecutionState::isGEPExpr(ref<Expr> expr) const {
-  return UseGEPOptimization && gepExprBases.find(expr) != gepExprBases.end();
+  return UseGEPOptimization && gepExprBases.count(expr);
 }
 
 bool ExecutionState::visited(KBlock *block) const {
@@ -12,6 +12,7 @@
 
 #include "AddressSpace.h"
 
+#include "klee/ADT/CopyOnWrite.h"
 #include "klee/ADT/FixedSizeStorageAdapter.h"
 #include "klee/ADT/ImmutableList.h"
 #include "klee/ADT/ImmutableSet.h"
@@ -85,10 +86,34 @@ struct CallStackFrame {
   bool operator==(const CallStackFrame &other) const { return equals(other); }
 };
 
+/// Registers of a stack frame. Copies share the registers until one of them
+/// is written, so forking a state does not copy the registers of its frames.
+class FrameLocals {
+  std::shared_ptr<FixedSizeStorageAdapter<Cell>> storage;
+
+public:
+  explicit FrameLocals(size_t size);
+
+  const Cell &at(size_t reg) const { return storage->at(reg); }
+  size_t size() const { return storage->size(); }
+
+  void set(size_t reg, const Cell &cell) {
+    if (storage.use_count() > 1)
+      storage.reset(storage->clone());
+    storage->set(reg, cell);
+  }
+
+  /// Resets all registers to unset values
+  void clear();
+
+  /// Number of frames sharing these registers
+  size_t sharers() const { return storage.use_count(); }
+};
+
 struct StackFrame {
   KFunction *kf;
   std::vector<ref<const MemoryObject>> allocas;
-  std::unique_ptr<FixedSizeStorageAdapter<Cell>> locals;
+  FrameLocals locals;
 
   // For vararg functions: arguments not passed via parameter are
   // stored (packed tightly) in a local (alloca) memory object. This
@@ -164,6 +189,9 @@ public:
 
   inline unsigned size() const { return callStack_.size(); }
   inline size_t stackRegisterSize() const { return stackSize; }
+
+  /// Estimated number of bytes allocated for the frames and their registers
+  size_t getMemoryUsage() const;
   inline bool empty() const { return callStack_.empty(); }
 };
 
@@ -279,6 +307,24 @@ struct MemorySubobjectCompare {
 
 typedef std::pair<llvm::BasicBlock *, llvm::BasicBlock *> Transition;
 
+class ExecutionState;
+
+/// States forked inside the same acyclic region, which wait for each other
+/// at the exit of the region to be merged (see --merge-regions)
+struct MergeGroup {
+  /// First instruction of the exit block after its PHI nodes
+  KInstruction *exit;
+  /// Stack size of the members
+  unsigned stackSize;
+  /// Number of members which have not terminated yet
+  unsigned live = 0;
+  /// Members waiting at the exit
+  std::vector<ExecutionState *> held;
+
+  MergeGroup(KInstruction *exit, unsigned stackSize)
+      : exit(exit), stackSize(stackSize) {}
+};
+
 /// @brief ExecutionState representing a path under exploration
 class ExecutionState {
 #ifdef KLEE_UNITTEST
@@ -363,7 +409,7 @@ public:
   ImmutableList<Symbolic> symbolics;
 
   /// @brief map from memory accesses to accessed objects and access offsets.
-  ExprHashMap<std::set<ref<const MemoryObject>>> resolvedPointers;
+  PersistentMap<ref<Expr>, std::set<ref<const MemoryObject>>> resolvedPointers;
   std::unordered_map<MemorySubobject, std::set<ref<const MemoryObject>>,
                      MemorySubobjectHash, MemorySubobjectCompare>
       resolvedSubobjects;
@@ -373,7 +419,7 @@ public:
   ImmutableSet<ref<Expr>> cexPreferences;
 
   /// @brief Set of used array names for this state.  Used to avoid collisions.
-  std::map<std::string, uint64_t> arrayNames;
+  PersistentMap<std::string, uint64_t> arrayNames;
 
   /// @brief The numbers of times this state has run through
   /// Executor::stepInstruction
@@ -387,6 +433,11 @@ public:
   /// instruction was covered.
   std::uint32_t instsSinceCovNew = 0;
 
+  /// @brief Bytes attributed to this state by the last memory accounting
+  /// (see Executor::accountStateMemory). An object bound in several states
+  /// is split evenly among them.
+  std::uint64_t memoryUsage = 0;
+
   ///@brief State cfenv rounding mode
   llvm::APFloat::roundingMode roundingMode = llvm::APFloat::rmNearestTiesToEven;
 
@@ -400,7 +451,7 @@ public:
   std::uint32_t id = 0;
 
   /// @brief Whether a new instruction was covered in this state
-  mutable std::deque<ref<box<bool>>> coveredNew;
+  mutable CopyOnWrite<std::deque<ref<box<bool>>>> coveredNew;
   mutable ref<box<bool>> coveredNewError;
 
   /// @brief Disables forking for this state. Set by user code
@@ -408,10 +459,17 @@ public:
 
   bool afterFork = false;
 
+  /// @brief Branch condition taken by this state at a lazy fork whose
+  /// feasibility has not been checked yet (see --lazy-forks)
+  ref<Expr> uncheckedCondition;
+
+  /// @brief Region this state waits to be merged in, if any
+  std::shared_ptr<MergeGroup> mergeGroup;
+
   /// Needed for composition
   ref<Expr> returnValue;
 
-  ExprHashMap<llvm::Type *> gepExprBases;
+  PersistentMap<ref<Expr>, llvm::Type *> gepExprBases;
 
   mutable ReachWithError error = ReachWithError::None;
   std::atomic<HaltExecution::Reason> terminationReasonType{
@@ -451,6 +509,13 @@ public:
 
   bool inSymbolics(const MemoryObject *mo) const;
 
+  /// Merges `b` into this state: registers and memory bytes which differ
+  /// become selects on the constraints only this state has, and the path
+  /// constraints become their common part and the disjunction of the rest.
+  /// Returns false, leaving the state unchanged, if the states are at
+  /// different locations or have different objects.
+  bool merge(const ExecutionState &b);
+
   void pushFrame(KInstIterator caller, KFunction *kf);
   void popFrame();
 
@@ -569,24 +634,26 @@ public:
   }
 
   bool isCoveredNew() const {
-    return !coveredNew.empty() && coveredNew.back()->value;
+    return !coveredNew->empty() && coveredNew->back()->value;
   }
   bool isCoveredNewError() const { return coveredNewError->value; }
   void coverNew() const {
-    coveredNew.push_back(new box<bool>(true));
+    coveredNew.mutate().push_back(new box<bool>(true));
     coveredNewError->value = false;
     coveredNewError = new box<bool>(true);
   }
   void updateCoveredNew() const {
-    while (!coveredNew.empty() && !coveredNew.front()->value) {
-      coveredNew.pop_front();
+    while (!coveredNew->empty() && !coveredNew->front()->value) {
+      coveredNew.mutate().pop_front();
     }
   }
   void clearCoveredNew() const {
-    for (auto signal : coveredNew) {
+    if (coveredNew->empty())
+      return;
+    for (auto signal : *coveredNew) {
       signal->value = false;
     }
-    coveredNew.clear();
+    coveredNew.mutate().clear();
   }
   void clearCoveredNewError() const { coveredNewError->value = false; }
 };
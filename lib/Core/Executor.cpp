@@ -26,6 +26,7 @@
 #include "Searcher.h"
 #include "SeedInfo.h"
 #include "SpecialFunctionHandler.h"
+#include "StateSpiller.h"
 #include "StatsTracker.h"
 #include "TargetCalculator.h"
 #include "TargetManager.h"
@@ -214,6 +215,47 @@ cl::opt<std::string> FunctionCallReproduce(
     cl::desc("Marks mentioned function as target for error-guided mode."),
     cl::cat(ExecCat));
 
+cl::opt<bool> MergeRegions(
+    "merge-regions", cl::init(false),
+    cl::desc("Merge the states forked at a branch once they all reach the "
+             "end of the acyclic, call-free region the branch starts "
+             "(default=false)"),
+    cl::cat(ExecCat));
+
+cl::opt<bool> JitConcreteBlocks(
+    "jit-concrete-blocks", cl::init(false),
+    cl::desc("Compile hot basic blocks of integer arithmetic to native code "
+             "and run them natively while the registers they read are "
+             "concrete (default=false)"),
+    cl::cat(ExecCat));
+
+cl::opt<unsigned> JitHotBlockThreshold(
+    "jit-hot-block-threshold", cl::init(1000),
+    cl::desc("Number of times a basic block is entered before it is compiled "
+             "(see --jit-concrete-blocks) (default=1000)"),
+    cl::cat(ExecCat));
+
+cl::opt<bool> SpillStates(
+    "spill-states", cl::init(false),
+    cl::desc("Write states to a spill file in the output directory instead of "
+             "terminating them when the memory cap is exceeded, and read them "
+             "back once they are selected again (default=false)"),
+    cl::cat(ExecCat));
+
+cl::opt<unsigned> MaxResidentStates(
+    "max-resident-states", cl::init(0),
+    cl::desc("Spill states to the spill file while more than this many are "
+             "kept in memory (see --spill-states). Set to 0 to disable "
+             "(default=0)"),
+    cl::cat(ExecCat));
+
+cl::opt<bool> EvictLargestStates(
+    "evict-largest-states", cl::init(false),
+    cl::desc("When the memory cap is exceeded, spill or terminate the states "
+             "with the most memory attributed to them instead of random "
+             "states (default=false)"),
+    cl::cat(ExecCat));
+
 llvm::cl::opt<bool> X86FPAsX87FP80(
     "x86FP-as-x87FP80", cl::init(false),
     cl::desc("Convert X86 fp values to X87FP80 during computation according to "
@@ -279,6 +321,22 @@ cl::opt<unsigned> MaxSymArraySize(
         "into this array are concretized.  Set to 0 to disable (default=0)"),
     cl::init(0), cl::cat(SolvingCat));
 
+cl::opt<unsigned> AsyncSolverWorkers(
+    "async-solver-workers", cl::init(0),
+    cl::desc("Number of background solver workers. A state reaching a "
+             "symbolic branch is parked while a worker evaluates the branch "
+             "condition, and other states are stepped meanwhile. Each worker "
+             "is a forked process. Set to 0 to disable (default=0)"),
+    cl::cat(SolvingCat));
+
+cl::opt<bool> LazyForks(
+    "lazy-forks", cl::init(false),
+    cl::desc("Do not check the feasibility of both sides of a symbolic branch "
+             "when forking. Each side is checked when its state is first "
+             "selected by the searcher, and dropped if infeasible "
+             "(default=false)"),
+    cl::cat(SolvingCat));
+
 cl::opt<bool>
     SimplifySymIndices("simplify-sym-indices", cl::init(true),
                        cl::desc("Simplify symbolic accesses using equalities "
@@ -390,6 +448,16 @@ cl::opt<std::string>
                       "search (default=0s (off))"),
              cl::cat(SeedingCat));
 
+/*** Scheduling options ***/
+
+cl::opt<unsigned> StateWorkers(
+    "state-workers", cl::init(1),
+    cl::desc("Number of workers stepping distinct states between two "
+             "subscriber updates. Workers are interleaved on the interpreter "
+             "thread, and the states they add and remove are published in a "
+             "single batch (default=1)"),
+    cl::cat(ExecCat));
+
 /*** Debugging options ***/
 
 /// The different query logging solvers that can switched on/off
@@ -1396,8 +1464,23 @@ Executor::StatePair Executor::fork(ExecutionState &current, ref<Expr> condition,
                                  StateTerminationType::MissedAllTargets);
     return StatePair(nullptr, nullptr);
   }
+  // A lazy fork assumes both sides are feasible and leaves the check to
+  // checkLazyFork() once a side is selected. Only plain forks qualify: the
+  // seeding, replay and fork-inhibiting logic below needs the real answer.
+  bool lazy = LazyForks && !isa<ConstantExpr>(condition) && !isInternal &&
+              !isSeeding && !replayPath &&
+              !replayKTest && !current.forkDisabled && !inhibitForking &&
+              !(MaxMemoryInhibit && atMemoryLimit) &&
+              (MaxForks == ~0u || stats::forks < MaxForks);
   if (res != PartialValidity::None) {
     success = true;
+  } else if (resumedBranch && resumedBranch->state == &current &&
+             resumedBranch->success && resumedBranch->condition == condition) {
+    res = resumedBranch->validity;
+    resumedBranch = nullptr;
+  } else if (lazy) {
+    res = PValidity::TrueOrFalse;
+    ++stats::lazyForks;
   } else {
     success = solver->evaluate(current.constraints.cs(), condition, res,
                                current.queryMetaData);
@@ -1574,8 +1657,17 @@ Executor::StatePair Executor::fork(ExecutionState &current, ref<Expr> condition,
 
     trueState->afterFork = true;
     falseState->afterFork = true;
-    addConstraint(*trueState, condition);
-    addConstraint(*falseState, Expr::createIsZero(condition));
+    if (lazy) {
+      trueState->uncheckedCondition = condition;
+      falseState->uncheckedCondition = Expr::createIsZero(condition);
+    } else {
+      addConstraint(*trueState, condition);
+      addConstraint(*falseState, Expr::createIsZero(condition));
+    }
+
+    if (MergeRegions && !trueState->mergeGroup && !isInternal && !isSeeding &&
+        !replayPath && !replayKTest)
+      openMergeGroup(*trueState, *falseState);
 
     // Kinda gross, do we even really still want this option?
     if (MaxDepth && MaxDepth <= trueState->depth) {
@@ -1652,11 +1744,10 @@ const Cell &Executor::eval(const KInstruction *ki, unsigned index,
     return kmodule->constantTable[index];
   } else {
     unsigned index = vnumber;
-    ref<Expr> reg = sf.locals->at(index).value;
-    if (isSymbolic && reg.isNull()) {
+    if (isSymbolic && sf.locals.at(index).isNull()) {
       prepareSymbolicRegister(state, sf, index);
     }
-    return sf.locals->at(index);
+    return sf.locals.at(index);
   }
 }
 
@@ -1680,6 +1771,11 @@ void Executor::bindLocal(const KInstruction *target, ExecutionState &state,
   setDestCell(state, target, value);
 }
 
+void Executor::bindLocal(const KInstruction *target, ExecutionState &state,
+                         const Cell &value) {
+  setDestCell(state.stack.valueStack().back(), target, value);
+}
+
 void Executor::bindArgument(KFunction *kf, unsigned index,
                             ExecutionState &state, ref<Expr> value) {
   setArgumentCell(state, kf, index, value);
@@ -2161,6 +2257,12 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
   Instruction *i = ki->inst();
   if (isa_and_nonnull<DbgInfoIntrinsic>(i))
     return;
+  if (f && specialFunctionHandler->handleFastPath(state, f, ki, arguments)) {
+    if (InvokeInst *ii = dyn_cast<InvokeInst>(i)) {
+      transferToBasicBlock(ii->getNormalDest(), i->getParent(), state);
+    }
+    return;
+  }
   if (f && f->isDeclaration()) {
 #ifndef ENABLE_FP
     Intrinsic::ID id = f->getIntrinsicID();
@@ -2205,7 +2307,7 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
 
       bindLocal(ki, state, ConstantExpr::alloc(Res.bitcastToAPInt()));
 #else
-      ref<Expr> op = eval(ki, 1, state).value;
+      ref<Expr> op = eval(ki, 1, state).value();
       ref<Expr> result = FAbsExpr::create(op);
       bindLocal(ki, state, result);
 #endif
@@ -2213,7 +2315,7 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
     }
 #ifdef ENABLE_FP
     case Intrinsic::sqrt: {
-      ref<Expr> op = eval(ki, 1, state).value;
+      ref<Expr> op = eval(ki, 1, state).value();
       ref<Expr> result = FSqrtExpr::create(op, state.roundingMode);
       bindLocal(ki, state, result);
       break;
@@ -2221,8 +2323,8 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
 
     case Intrinsic::maxnum:
     case Intrinsic::minnum: {
-      ref<Expr> op1 = eval(ki, 1, state).value;
-      ref<Expr> op2 = eval(ki, 2, state).value;
+      ref<Expr> op1 = eval(ki, 1, state).value();
+      ref<Expr> op2 = eval(ki, 2, state).value();
       assert(op1->getWidth() == op2->getWidth() && "type mismatch");
       ref<Expr> result;
       if (f->getIntrinsicID() == Intrinsic::maxnum) {
@@ -2236,7 +2338,7 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
     case Intrinsic::trunc: {
       FPTruncInst *fi = cast<FPTruncInst>(i);
       Expr::Width resultType = getWidthForLLVMType(fi->getType());
-      ref<Expr> arg = eval(ki, 0, state).value;
+      ref<Expr> arg = eval(ki, 0, state).value();
       if (!fpWidthToSemantics(arg->getWidth()) ||
           !fpWidthToSemantics(resultType))
         return terminateStateOnExecError(state,
@@ -2249,7 +2351,7 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
       break;
     }
     case Intrinsic::rint: {
-      ref<Expr> arg = eval(ki, 0, state).value;
+      ref<Expr> arg = eval(ki, 0, state).value();
       ref<Expr> result = FRintExpr::create(arg, state.roundingMode);
       bindLocal(ki, state, result);
       break;
@@ -2269,11 +2371,11 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
             state, f->getName() + " with vectors is not supported");
 
       ref<ConstantExpr> op1 =
-          toConstant(state, eval(ki, 1, state).value, "floating point");
+          toConstant(state, eval(ki, 1, state).value(), "floating point");
       ref<ConstantExpr> op2 =
-          toConstant(state, eval(ki, 2, state).value, "floating point");
+          toConstant(state, eval(ki, 2, state).value(), "floating point");
       ref<ConstantExpr> op3 =
-          toConstant(state, eval(ki, 3, state).value, "floating point");
+          toConstant(state, eval(ki, 3, state).value(), "floating point");
 
       if (!fpWidthToSemantics(op1->getWidth()) ||
           !fpWidthToSemantics(op2->getWidth()) ||
@@ -2291,9 +2393,9 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
       bindLocal(ki, state, ConstantExpr::alloc(Res.bitcastToAPInt()));
       break;
 #else
-      ref<Expr> op1 = eval(ki, 1, state).value;
-      ref<Expr> op2 = eval(ki, 2, state).value;
-      ref<Expr> op3 = eval(ki, 3, state).value;
+      ref<Expr> op1 = eval(ki, 1, state).value();
+      ref<Expr> op2 = eval(ki, 2, state).value();
+      ref<Expr> op3 = eval(ki, 3, state).value();
       assert(op1->getWidth() == op2->getWidth() &&
              op2->getWidth() == op3->getWidth() && "type mismatch");
       ref<Expr> result =
@@ -2310,8 +2412,8 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
         return terminateStateOnExecError(
             state, "llvm.abs with vectors is not supported");
 
-      ref<Expr> op = eval(ki, 1, state).value;
-      ref<Expr> poison = eval(ki, 2, state).value;
+      ref<Expr> op = eval(ki, 1, state).value();
+      ref<Expr> poison = eval(ki, 2, state).value();
 
       assert(poison->getWidth() == 1 && "Second argument is not an i1");
       unsigned bw = op->getWidth();
@@ -2352,8 +2454,8 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
         return terminateStateOnExecError(
             state, "llvm.{s,u}{max,min} with vectors is not supported");
 
-      ref<Expr> op1 = eval(ki, 1, state).value;
-      ref<Expr> op2 = eval(ki, 2, state).value;
+      ref<Expr> op1 = eval(ki, 1, state).value();
+      ref<Expr> op2 = eval(ki, 2, state).value();
 
       ref<Expr> cond = nullptr;
       if (f->getIntrinsicID() == Intrinsic::smax)
@@ -2373,9 +2475,9 @@ void Executor::executeCall(ExecutionState &state, KInstruction *ki, Function *f,
 
     case Intrinsic::fshr:
     case Intrinsic::fshl: {
-      ref<Expr> op1 = eval(ki, 1, state).value;
-      ref<Expr> op2 = eval(ki, 2, state).value;
-      ref<Expr> op3 = eval(ki, 3, state).value;
+      ref<Expr> op1 = eval(ki, 1, state).value();
+      ref<Expr> op2 = eval(ki, 2, state).value();
+      ref<Expr> op3 = eval(ki, 3, state).value();
       unsigned w = op1->getWidth();
       assert(w == op2->getWidth() && "type mismatch");
       assert(w == op3->getWidth() && "type mismatch");
@@ -2707,6 +2809,190 @@ void Executor::checkNullCheckAfterDeref(ref<Expr> cond, ExecutionState &state) {
   }
 }
 
+bool Executor::executeConcreteInstruction(ExecutionState &state,
+                                          KInstruction *ki) {
+  Instruction *i = ki->inst();
+  unsigned opcode = i->getOpcode();
+  switch (opcode) {
+  case Instruction::Add:
+  case Instruction::Sub:
+  case Instruction::Mul:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+  case Instruction::ICmp: {
+    const Cell &leftCell = eval(ki, 0, state);
+    if (!leftCell.isConstant())
+      return false;
+    Expr::Width width = leftCell.getWidth();
+    uint64_t left = leftCell.getZExtValue();
+    int64_t sleft = leftCell.getSExtValue();
+    const Cell &rightCell = eval(ki, 1, state);
+    if (!rightCell.isConstant())
+      return false;
+    uint64_t right = rightCell.getZExtValue();
+    int64_t sright = rightCell.getSExtValue();
+
+    if (opcode == Instruction::ICmp) {
+      bool result;
+      switch (cast<ICmpInst>(i)->getPredicate()) {
+      case ICmpInst::ICMP_EQ:
+        result = left == right;
+        break;
+      case ICmpInst::ICMP_NE:
+        result = left != right;
+        break;
+      case ICmpInst::ICMP_UGT:
+        result = left > right;
+        break;
+      case ICmpInst::ICMP_UGE:
+        result = left >= right;
+        break;
+      case ICmpInst::ICMP_ULT:
+        result = left < right;
+        break;
+      case ICmpInst::ICMP_ULE:
+        result = left <= right;
+        break;
+      case ICmpInst::ICMP_SGT:
+        result = sleft > sright;
+        break;
+      case ICmpInst::ICMP_SGE:
+        result = sleft >= sright;
+        break;
+      case ICmpInst::ICMP_SLT:
+        result = sleft < sright;
+        break;
+      case ICmpInst::ICMP_SLE:
+        result = sleft <= sright;
+        break;
+      default:
+        return false;
+      }
+      bindLocal(ki, state, Cell(result, Expr::Bool));
+      return true;
+    }
+
+    uint64_t result;
+    switch (opcode) {
+    case Instruction::Add:
+      result = left + right;
+      break;
+    case Instruction::Sub:
+      result = left - right;
+      break;
+    case Instruction::Mul:
+      result = left * right;
+      break;
+    case Instruction::And:
+      result = left & right;
+      break;
+    case Instruction::Or:
+      result = left | right;
+      break;
+    case Instruction::Xor:
+      result = left ^ right;
+      break;
+    // Overshifts are left to the expression builder.
+    case Instruction::Shl:
+      if (right >= width)
+        return false;
+      result = left << right;
+      break;
+    case Instruction::LShr:
+      if (right >= width)
+        return false;
+      result = left >> right;
+      break;
+    case Instruction::AShr:
+      if (right >= width)
+        return false;
+      result = sleft >> right;
+      break;
+    default:
+      return false;
+    }
+    bindLocal(ki, state, Cell(result, width));
+    return true;
+  }
+
+  case Instruction::Trunc:
+  case Instruction::ZExt:
+  case Instruction::SExt: {
+    Expr::Width width = getWidthForLLVMType(i->getType());
+    if (width > Expr::Int64)
+      return false;
+    const Cell &arg = eval(ki, 0, state);
+    if (!arg.isConstant())
+      return false;
+    uint64_t result = opcode == Instruction::SExt ? arg.getSExtValue()
+                                                   : arg.getZExtValue();
+    bindLocal(ki, state, Cell(result, width));
+    return true;
+  }
+
+  default:
+    return false;
+  }
+}
+
+bool Executor::executeCompiledBlock(ExecutionState &state) {
+  KInstruction *ki = state.pc;
+  // Only look the block up when it was just entered.
+  if (state.prevPC && state.prevPC->parent == ki->parent &&
+      !isa<PHINode>(state.prevPC->inst()))
+    return false;
+  if (isa<PHINode>(ki->inst()))
+    return false;
+
+  const KBlock *kb = ki->parent;
+  auto it = hotBlocks.find(kb);
+  if (it == hotBlocks.end()) {
+    unsigned begin = 0;
+    while (isa<PHINode>(kb->instructions[begin]->inst()))
+      ++begin;
+    it = hotBlocks.emplace(kb, HotBlock(begin)).first;
+  }
+  HotBlock &hot = it->second;
+  if (ki != kb->instructions[hot.begin])
+    return false;
+
+  if (!hot.compiled) {
+    if (++hot.hits < JitHotBlockThreshold)
+      return false;
+    hot.compiled = true;
+    if (!externalDispatcher->compileBlock(kb, hot.begin, hot.code))
+      return false;
+  }
+  CompiledBlock &code = hot.code;
+  if (!code.function)
+    return false;
+
+  StackFrame &sf = state.stack.valueStack().back();
+  blockInputs.resize(std::max(blockInputs.size(), code.inputs.size()));
+  blockOutputs.resize(std::max(blockOutputs.size(), code.outputs.size()));
+  for (unsigned i = 0; i < code.inputs.size(); ++i) {
+    const Cell &cell = sf.locals.at(code.inputs[i]);
+    if (!cell.isConstant())
+      return false;
+    blockInputs[i] = cell.getZExtValue();
+  }
+  if (!code.function(blockInputs.data(), blockOutputs.data()))
+    return false;
+
+  for (unsigned i = 0; i < code.outputs.size(); ++i)
+    sf.locals.set(code.outputs[i].first,
+                  Cell(blockOutputs[i], code.outputs[i].second));
+  // Account for the instructions as if they were interpreted.
+  for (unsigned i = 0; i < code.outputs.size(); ++i)
+    stepInstruction(state);
+  ++stats::jitExecutedBlocks;
+  return true;
+}
+
 void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   Instruction *i = ki->inst();
 
@@ -2724,6 +3010,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     }
   }
 
+  if (executeConcreteInstruction(state, ki))
+    return;
+
   switch (i->getOpcode()) {
     // Control flow
   case Instruction::Ret: {
@@ -2734,7 +3023,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     ref<Expr> result = ConstantExpr::alloc(0, Expr::Bool);
 
     if (!isVoidReturn) {
-      result = eval(ki, 0, state).value;
+      result = eval(ki, 0, state).value();
     }
 
     if (state.stack.size() <= 1) {
@@ -2858,7 +3147,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     } else {
       // FIXME: Find a way that we don't have this hidden dependency.
       assert(bi->getCondition() == bi->getOperand(0) && "Wrong operand index!");
-      ref<Expr> cond = eval(ki, 0, state).value;
+      ref<Expr> cond = eval(ki, 0, state).value();
 
       cond = optimizer.optimizeExpr(cond, false);
 
@@ -2906,7 +3195,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::IndirectBr: {
     // implements indirect branch to a label within the current function
     const auto bi = cast<IndirectBrInst>(i);
-    auto address = eval(ki, 0, state).value;
+    auto address = eval(ki, 0, state).value();
     address = toUnique(state, address);
 
     // concrete address
@@ -2987,7 +3276,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
   case Instruction::Switch: {
     SwitchInst *si = cast<SwitchInst>(i);
-    ref<Expr> cond = eval(ki, 0, state).value;
+    ref<Expr> cond = eval(ki, 0, state).value();
     BasicBlock *bb = si->getParent();
 
     cond = toUnique(state, cond);
@@ -3155,7 +3444,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     arguments.reserve(numArgs);
 
     for (unsigned j = 0; j < numArgs; ++j)
-      arguments.push_back(eval(ki, j + 1, state).value);
+      arguments.push_back(eval(ki, j + 1, state).value());
 
     if (auto *asmValue =
             dyn_cast<InlineAsm>(fp)) { // TODO: move to `executeCall`
@@ -3211,7 +3500,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 
       executeCall(state, ki, f, arguments);
     } else {
-      ref<Expr> v = eval(ki, 0, state).value;
+      ref<Expr> v = eval(ki, 0, state).value();
 
       ExecutionState *free = &state;
       bool hasInvalid = false, first = true;
@@ -3269,7 +3558,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     if (state.incomingBBIndex == -1)
       prepareSymbolicValue(state, ki);
     else {
-      ref<Expr> result = eval(ki, state.incomingBBIndex, state).value;
+      Cell result = eval(ki, state.incomingBBIndex, state);
       bindLocal(ki, state, result);
     }
     break;
@@ -3278,9 +3567,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     // Special instructions
   case Instruction::Select: {
     // NOTE: It is not required that operands 1 and 2 be of scalar type.
-    ref<Expr> cond = eval(ki, 0, state).value;
-    ref<Expr> tExpr = eval(ki, 1, state).value;
-    ref<Expr> fExpr = eval(ki, 2, state).value;
+    ref<Expr> cond = eval(ki, 0, state).value();
+    ref<Expr> tExpr = eval(ki, 1, state).value();
+    ref<Expr> fExpr = eval(ki, 2, state).value();
     ref<Expr> result = SelectExpr::create(cond, tExpr, fExpr);
     bindLocal(ki, state, result);
     break;
@@ -3293,101 +3582,101 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     // Arithmetic / logical
 
   case Instruction::Add: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     bindLocal(ki, state, AddExpr::create(left, right));
     break;
   }
 
   case Instruction::Sub: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     bindLocal(ki, state, SubExpr::create(left, right));
     break;
   }
 
   case Instruction::Mul: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     bindLocal(ki, state, MulExpr::create(left, right));
     break;
   }
 
   case Instruction::UDiv: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = UDivExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
   }
 
   case Instruction::SDiv: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = SDivExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
   }
 
   case Instruction::URem: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = URemExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
   }
 
   case Instruction::SRem: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = SRemExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
   }
 
   case Instruction::And: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = AndExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
   }
 
   case Instruction::Or: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = OrExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
   }
 
   case Instruction::Xor: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = XorExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
   }
 
   case Instruction::Shl: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = ShlExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
   }
 
   case Instruction::LShr: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = LShrExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
   }
 
   case Instruction::AShr: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     ref<Expr> result = AShrExpr::create(left, right);
     bindLocal(ki, state, result);
     break;
@@ -3401,80 +3690,80 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 
     switch (ii->getPredicate()) {
     case ICmpInst::ICMP_EQ: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = EqExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
     }
 
     case ICmpInst::ICMP_NE: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = NeExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
     }
 
     case ICmpInst::ICMP_UGT: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = UgtExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
     }
 
     case ICmpInst::ICMP_UGE: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = UgeExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
     }
 
     case ICmpInst::ICMP_ULT: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = UltExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
     }
 
     case ICmpInst::ICMP_ULE: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = UleExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
     }
 
     case ICmpInst::ICMP_SGT: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = SgtExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
     }
 
     case ICmpInst::ICMP_SGE: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = SgeExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
     }
 
     case ICmpInst::ICMP_SLT: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = SltExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
     }
 
     case ICmpInst::ICMP_SLE: {
-      ref<Expr> left = eval(ki, 0, state).value;
-      ref<Expr> right = eval(ki, 1, state).value;
+      ref<Expr> left = eval(ki, 0, state).value();
+      ref<Expr> right = eval(ki, 1, state).value();
       ref<Expr> result = SleExpr::create(left, right);
       bindLocal(ki, state, result);
       break;
@@ -3499,7 +3788,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
         kmodule->targetData->getTypeAllocSize(ai->getAllocatedType());
     ref<Expr> size = Expr::createPointer(elementSize);
     if (ai->isArrayAllocation()) {
-      ref<Expr> count = eval(ki, 0, state).value;
+      ref<Expr> count = eval(ki, 0, state).value();
       count = Expr::createZExtToPointerWidth(count);
       size = MulExpr::create(size, count);
     }
@@ -3508,13 +3797,13 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
 
   case Instruction::Load: {
-    ref<Expr> base = eval(ki, 0, state).value;
+    ref<Expr> base = eval(ki, 0, state).value();
     executeMemoryOperation(state, false, makePointer(base), 0, ki);
     break;
   }
   case Instruction::Store: {
-    ref<Expr> base = eval(ki, 1, state).value;
-    ref<Expr> value = eval(ki, 0, state).value;
+    ref<Expr> base = eval(ki, 1, state).value();
+    ref<Expr> value = eval(ki, 0, state).value();
     executeMemoryOperation(state, true, makePointer(base), value, ki);
     break;
   }
@@ -3524,7 +3813,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     GetElementPtrInst *gepInst =
         static_cast<GetElementPtrInst *>(kgepi->inst());
 
-    ref<Expr> base = eval(ki, 0, state).value;
+    ref<Expr> base = eval(ki, 0, state).value();
     ref<PointerExpr> pointer = makePointer(base);
     base = pointer->getBase();
     ref<Expr> offset = pointer->getOffset();
@@ -3534,7 +3823,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
              ie = kgepi->indices.end();
          it != ie; ++it) {
       uint64_t elementSize = it->second;
-      ref<Expr> index = eval(ki, it->first, state).value;
+      ref<Expr> index = eval(ki, it->first, state).value();
       offset = AddExpr::create(
           offset, MulExpr::create(Expr::createSExtToPointerWidth(index),
                                   Expr::createPointer(elementSize)));
@@ -3549,7 +3838,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
       address = PointerExpr::create(base, AddExpr::create(base, offset));
     }
 
-    state.gepExprBases[base] = {gepInst->getSourceElementType()};
+    state.gepExprBases.replace({base, gepInst->getSourceElementType()});
 
     bindLocal(ki, state, address);
     break;
@@ -3558,21 +3847,21 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     // Conversion
   case Instruction::Trunc: {
     CastInst *ci = cast<CastInst>(i);
-    ref<Expr> result = ExtractExpr::create(eval(ki, 0, state).value, 0,
+    ref<Expr> result = ExtractExpr::create(eval(ki, 0, state).value(), 0,
                                            getWidthForLLVMType(ci->getType()));
     bindLocal(ki, state, result);
     break;
   }
   case Instruction::ZExt: {
     CastInst *ci = cast<CastInst>(i);
-    ref<Expr> result = ZExtExpr::create(eval(ki, 0, state).value,
+    ref<Expr> result = ZExtExpr::create(eval(ki, 0, state).value(),
                                         getWidthForLLVMType(ci->getType()));
     bindLocal(ki, state, result);
     break;
   }
   case Instruction::SExt: {
     CastInst *ci = cast<CastInst>(i);
-    ref<Expr> result = SExtExpr::create(eval(ki, 0, state).value,
+    ref<Expr> result = SExtExpr::create(eval(ki, 0, state).value(),
                                         getWidthForLLVMType(ci->getType()));
     bindLocal(ki, state, result);
     break;
@@ -3581,20 +3870,20 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::IntToPtr: {
     CastInst *ci = cast<CastInst>(i);
     Expr::Width pType = getWidthForLLVMType(ci->getType());
-    ref<Expr> arg = eval(ki, 0, state).value;
+    ref<Expr> arg = eval(ki, 0, state).value();
     bindLocal(ki, state, PointerExpr::create(ZExtExpr::create(arg, pType)));
     break;
   }
   case Instruction::PtrToInt: {
     CastInst *ci = cast<CastInst>(i);
     Expr::Width iType = getWidthForLLVMType(ci->getType());
-    ref<Expr> arg = eval(ki, 0, state).value;
+    ref<Expr> arg = eval(ki, 0, state).value();
     bindLocal(ki, state, ZExtExpr::create(arg, iType));
     break;
   }
 
   case Instruction::BitCast: {
-    ref<Expr> result = eval(ki, 0, state).value;
+    ref<Expr> result = eval(ki, 0, state).value();
     BitCastInst *bc = cast<BitCastInst>(ki->inst());
 
     llvm::Type *castToType = bc->getType();
@@ -3620,7 +3909,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 #ifndef ENABLE_FP
   case Instruction::FNeg: {
     ref<ConstantExpr> arg =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     if (!fpWidthToSemantics(arg->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FNeg operation");
 
@@ -3632,9 +3921,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 
   case Instruction::FAdd: {
     ref<ConstantExpr> left =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     ref<ConstantExpr> right =
-        toConstant(state, eval(ki, 1, state).value, "floating point");
+        toConstant(state, eval(ki, 1, state).value(), "floating point");
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FAdd operation");
@@ -3650,9 +3939,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 
   case Instruction::FSub: {
     ref<ConstantExpr> left =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     ref<ConstantExpr> right =
-        toConstant(state, eval(ki, 1, state).value, "floating point");
+        toConstant(state, eval(ki, 1, state).value(), "floating point");
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FSub operation");
@@ -3667,9 +3956,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 
   case Instruction::FMul: {
     ref<ConstantExpr> left =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     ref<ConstantExpr> right =
-        toConstant(state, eval(ki, 1, state).value, "floating point");
+        toConstant(state, eval(ki, 1, state).value(), "floating point");
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FMul operation");
@@ -3685,9 +3974,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 
   case Instruction::FDiv: {
     ref<ConstantExpr> left =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     ref<ConstantExpr> right =
-        toConstant(state, eval(ki, 1, state).value, "floating point");
+        toConstant(state, eval(ki, 1, state).value(), "floating point");
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FDiv operation");
@@ -3703,9 +3992,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 
   case Instruction::FRem: {
     ref<ConstantExpr> left =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     ref<ConstantExpr> right =
-        toConstant(state, eval(ki, 1, state).value, "floating point");
+        toConstant(state, eval(ki, 1, state).value(), "floating point");
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FRem operation");
@@ -3721,7 +4010,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     FPTruncInst *fi = cast<FPTruncInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
     ref<ConstantExpr> arg =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     if (!fpWidthToSemantics(arg->getWidth()) || resultType > arg->getWidth())
       return terminateStateOnExecError(state, "Unsupported FPTrunc operation");
 
@@ -3737,7 +4026,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     FPExtInst *fi = cast<FPExtInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
     ref<ConstantExpr> arg =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     if (!fpWidthToSemantics(arg->getWidth()) || arg->getWidth() > resultType)
       return terminateStateOnExecError(state, "Unsupported FPExt operation");
     llvm::APFloat Res(*fpWidthToSemantics(arg->getWidth()), arg->getAPValue());
@@ -3752,7 +4041,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     FPToUIInst *fi = cast<FPToUIInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
     ref<ConstantExpr> arg =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     if (!fpWidthToSemantics(arg->getWidth()) || resultType > 64)
       return terminateStateOnExecError(state, "Unsupported FPToUI operation");
 
@@ -3774,7 +4063,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     FPToSIInst *fi = cast<FPToSIInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
     ref<ConstantExpr> arg =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     if (!fpWidthToSemantics(arg->getWidth()) || resultType > 64)
       return terminateStateOnExecError(state, "Unsupported FPToSI operation");
     llvm::APFloat Arg(*fpWidthToSemantics(arg->getWidth()), arg->getAPValue());
@@ -3796,7 +4085,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     UIToFPInst *fi = cast<UIToFPInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
     ref<ConstantExpr> arg =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     const llvm::fltSemantics *semantics = fpWidthToSemantics(resultType);
     if (!semantics)
       return terminateStateOnExecError(state, "Unsupported UIToFP operation");
@@ -3812,7 +4101,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     SIToFPInst *fi = cast<SIToFPInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
     ref<ConstantExpr> arg =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     const llvm::fltSemantics *semantics = fpWidthToSemantics(resultType);
     if (!semantics)
       return terminateStateOnExecError(state, "Unsupported SIToFP operation");
@@ -3827,9 +4116,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::FCmp: {
     FCmpInst *fi = cast<FCmpInst>(i);
     ref<ConstantExpr> left =
-        toConstant(state, eval(ki, 0, state).value, "floating point");
+        toConstant(state, eval(ki, 0, state).value(), "floating point");
     ref<ConstantExpr> right =
-        toConstant(state, eval(ki, 1, state).value, "floating point");
+        toConstant(state, eval(ki, 1, state).value(), "floating point");
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FCmp operation");
@@ -3922,8 +4211,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
 #else
   case Instruction::FAdd: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FAdd operation");
@@ -3933,8 +4222,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
 
   case Instruction::FSub: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FSub operation");
@@ -3944,8 +4233,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
 
   case Instruction::FMul: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FMul operation");
@@ -3955,8 +4244,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
 
   case Instruction::FDiv: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FDiv operation");
@@ -3966,14 +4255,14 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
 
   case Instruction::FNeg: {
-    ref<Expr> expr = eval(ki, 0, state).value;
+    ref<Expr> expr = eval(ki, 0, state).value();
     bindLocal(ki, state, FNegExpr::create(expr));
     break;
   }
 
   case Instruction::FRem: {
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FRem operation");
@@ -3985,7 +4274,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::FPTrunc: {
     FPTruncInst *fi = cast<FPTruncInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
-    ref<Expr> arg = eval(ki, 0, state).value;
+    ref<Expr> arg = eval(ki, 0, state).value();
     if (!fpWidthToSemantics(arg->getWidth()) || !fpWidthToSemantics(resultType))
       return terminateStateOnExecError(state, "Unsupported FPTrunc operation");
     ref<Expr> result = arg;
@@ -4001,7 +4290,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::FPExt: {
     FPExtInst *fi = cast<FPExtInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
-    ref<Expr> arg = eval(ki, 0, state).value;
+    ref<Expr> arg = eval(ki, 0, state).value();
     if (!fpWidthToSemantics(arg->getWidth()) || !fpWidthToSemantics(resultType))
       return terminateStateOnExecError(state, "Unsupported FPExt operation");
     ref<Expr> result = arg;
@@ -4019,7 +4308,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::FPToUI: {
     FPToUIInst *fi = cast<FPToUIInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
-    ref<Expr> arg = eval(ki, 0, state).value;
+    ref<Expr> arg = eval(ki, 0, state).value();
     if (X86FPAsX87FP80 && Context::get().getPointerWidth() == 32) {
       arg = X87FP80ToFPTrunc(arg,
                              getWidthForLLVMType(fi->getOperand(0)->getType()),
@@ -4037,7 +4326,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::FPToSI: {
     FPToSIInst *fi = cast<FPToSIInst>(i);
     Expr::Width resultType = getWidthForLLVMType(fi->getType());
-    ref<Expr> arg = eval(ki, 0, state).value;
+    ref<Expr> arg = eval(ki, 0, state).value();
     if (X86FPAsX87FP80 && Context::get().getPointerWidth() == 32) {
       arg = X87FP80ToFPTrunc(arg,
                              getWidthForLLVMType(fi->getOperand(0)->getType()),
@@ -4058,7 +4347,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     if (X86FPAsX87FP80 && Context::get().getPointerWidth() == 32) {
       resultType = Expr::Fl80;
     }
-    ref<Expr> arg = eval(ki, 0, state).value;
+    ref<Expr> arg = eval(ki, 0, state).value();
     const llvm::fltSemantics *semantics = fpWidthToSemantics(resultType);
     if (!semantics)
       return terminateStateOnExecError(state, "Unsupported UIToFP operation");
@@ -4073,7 +4362,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
     if (X86FPAsX87FP80 && Context::get().getPointerWidth() == 32) {
       resultType = Expr::Fl80;
     }
-    ref<Expr> arg = eval(ki, 0, state).value;
+    ref<Expr> arg = eval(ki, 0, state).value();
     const llvm::fltSemantics *semantics = fpWidthToSemantics(resultType);
     if (!semantics)
       return terminateStateOnExecError(state, "Unsupported SIToFP operation");
@@ -4084,8 +4373,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
 
   case Instruction::FCmp: {
     FCmpInst *fi = cast<FCmpInst>(i);
-    ref<Expr> left = eval(ki, 0, state).value;
-    ref<Expr> right = eval(ki, 1, state).value;
+    ref<Expr> left = eval(ki, 0, state).value();
+    ref<Expr> right = eval(ki, 1, state).value();
     if (!fpWidthToSemantics(left->getWidth()) ||
         !fpWidthToSemantics(right->getWidth()))
       return terminateStateOnExecError(state, "Unsupported FCmp operation");
@@ -4098,8 +4387,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::InsertValue: {
     KGEPInstruction *kgepi = static_cast<KGEPInstruction *>(ki);
 
-    ref<Expr> agg = eval(ki, 0, state).value;
-    ref<Expr> val = eval(ki, 1, state).value;
+    ref<Expr> agg = eval(ki, 0, state).value();
+    ref<Expr> val = eval(ki, 1, state).value();
 
     ref<Expr> l = NULL, r = NULL;
     unsigned lOffset = kgepi->offset * 8,
@@ -4126,7 +4415,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   case Instruction::ExtractValue: {
     KGEPInstruction *kgepi = static_cast<KGEPInstruction *>(ki);
 
-    ref<Expr> agg = eval(ki, 0, state).value;
+    ref<Expr> agg = eval(ki, 0, state).value();
 
     ref<Expr> result = ExtractExpr::create(agg, kgepi->offset * 8,
                                            getWidthForLLVMType(i->getType()));
@@ -4140,9 +4429,9 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
   case Instruction::InsertElement: {
     InsertElementInst *iei = cast<InsertElementInst>(i);
-    ref<Expr> vec = eval(ki, 0, state).value;
-    ref<Expr> newElt = eval(ki, 1, state).value;
-    ref<Expr> idx = eval(ki, 2, state).value;
+    ref<Expr> vec = eval(ki, 0, state).value();
+    ref<Expr> newElt = eval(ki, 1, state).value();
+    ref<Expr> idx = eval(ki, 2, state).value();
 
     ConstantExpr *cIdx = dyn_cast<ConstantExpr>(idx);
     if (cIdx == NULL) {
@@ -4180,8 +4469,8 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
   }
   case Instruction::ExtractElement: {
     ExtractElementInst *eei = cast<ExtractElementInst>(i);
-    ref<Expr> vec = eval(ki, 0, state).value;
-    ref<Expr> idx = eval(ki, 1, state).value;
+    ref<Expr> vec = eval(ki, 0, state).value();
+    ref<Expr> idx = eval(ki, 1, state).value();
 
     ConstantExpr *cIdx = dyn_cast<ConstantExpr>(idx);
     if (cIdx == NULL) {
@@ -4225,7 +4514,7 @@ void Executor::executeInstruction(ExecutionState &state, KInstruction *ki) {
       break;
     }
 
-    ref<Expr> arg = eval(ki, 0, state).value;
+    ref<Expr> arg = eval(ki, 0, state).value();
     ref<Expr> exceptionPointer = ExtractExpr::create(arg, 0, Expr::Int64);
     ref<Expr> selectorValue =
         ExtractExpr::create(arg, Expr::Int64, Expr::Int32)->getValue();
@@ -4446,7 +4735,7 @@ void Executor::bindModuleConstants(llvm::APFloat::roundingMode rm) {
       std::unique_ptr<Cell[]>(new Cell[kmodule->constants.size()]);
   for (unsigned i = 0; i < kmodule->constants.size(); ++i) {
     Cell &c = kmodule->constantTable[i];
-    c.value = evalConstant(kmodule->constants[i], rm);
+    c = Cell(evalConstant(kmodule->constants[i], rm));
   }
 }
 
@@ -4484,29 +4773,137 @@ bool Executor::checkMemoryUsage() {
   if (totalUsage <= MaxMemory + 100)
     return true;
 
-  // just guess at how many to kill
   auto states = objectManager->getStates();
   const auto numStates = states.size();
-  auto toKill = std::max(1UL, numStates - numStates * MaxMemory / totalUsage);
+  unsigned long toKill, toSpill;
+  if (EvictLargestStates) {
+    // Not all memory is attributed to states, so evict the heaviest states
+    // until they hold the same share of the attributed memory as the excess
+    // of the total usage.
+    accountStateMemory();
+    std::vector<std::uint64_t> usages;
+    std::uint64_t attributed = 0;
+    for (const auto state : states) {
+      if (!spiller || !spiller->isSpilled(*state)) {
+        usages.push_back(state->memoryUsage);
+        attributed += state->memoryUsage;
+      }
+    }
+    std::sort(usages.begin(), usages.end(), std::greater<std::uint64_t>());
+    const auto excess = attributed * (totalUsage - MaxMemory) / totalUsage;
+    std::uint64_t evicted = 0;
+    toKill = 0;
+    while (toKill < usages.size() && evicted < excess)
+      evicted += usages[toKill++];
+    toKill = std::max(1UL, toKill);
+    toSpill = toKill;
+  } else {
+    // just guess at how many to kill
+    toKill = std::max(1UL, numStates - numStates * MaxMemory / totalUsage);
+    const auto resident = numStates - (spiller ? spiller->size() : 0);
+    toSpill = std::max(1UL, resident - resident * MaxMemory / totalUsage);
+  }
+
+  if (spiller) {
+    if (unsigned spilled = spillStates(toSpill)) {
+      klee_warning("spilled %u states to disk (over memory cap: %luMB)",
+                   spilled, totalUsage);
+      return true;
+    }
+  }
+
   klee_warning("killing %lu states (over memory cap: %luMB)", toKill,
                totalUsage);
 
-  // randomly select states for early termination
   std::vector<ExecutionState *> arr(states.begin(),
                                     states.end()); // FIXME: expensive
-  for (unsigned i = 0, N = arr.size(); N && i < toKill; ++i, --N) {
-    unsigned idx = theRNG.getInt32() % N;
+  for (unsigned i = 0; !arr.empty() && i < toKill; ++i) {
+    terminateStateEarly(*pickStateToEvict(arr), "Memory limit exceeded.",
+                        StateTerminationType::OutOfMemory);
+  }
+
+  return false;
+}
+
+ExecutionState *
+Executor::pickStateToEvict(std::vector<ExecutionState *> &candidates) {
+  assert(!candidates.empty());
+  const auto N = candidates.size();
+  unsigned idx;
+  if (EvictLargestStates) {
+    idx = std::max_element(candidates.begin(), candidates.end(),
+                           [](const ExecutionState *a,
+                              const ExecutionState *b) {
+                             return a->memoryUsage < b->memoryUsage ||
+                                    (a->memoryUsage == b->memoryUsage &&
+                                     a->id > b->id);
+                           }) -
+          candidates.begin();
+  } else {
+    idx = theRNG.getInt32() % N;
     // Make two pulls to try and not hit a state that
     // covered new code.
-    if (arr[idx]->isCoveredNew())
+    if (candidates[idx]->isCoveredNew())
       idx = theRNG.getInt32() % N;
+  }
+  std::swap(candidates[idx], candidates[N - 1]);
+  auto state = candidates.back();
+  candidates.pop_back();
+  return state;
+}
 
-    std::swap(arr[idx], arr[N - 1]);
-    terminateStateEarly(*arr[N - 1], "Memory limit exceeded.",
-                        StateTerminationType::OutOfMemory);
+std::uint64_t Executor::accountStateMemory() {
+  const auto &states = objectManager->getStates();
+
+  // an object bound in several address spaces is split evenly among them
+  struct SharedObject {
+    unsigned sharers = 0;
+    std::uint64_t size = 0;
+  };
+  std::unordered_map<const ObjectState *, SharedObject> objects;
+  for (const auto state : states) {
+    for (const auto &binding : state->addressSpace.objects)
+      ++objects[binding.second.get()].sharers;
   }
+  for (auto &object : objects)
+    object.second.size = object.first->getMemoryUsage();
 
-  return false;
+  std::uint64_t total = 0;
+  for (const auto state : states) {
+    std::uint64_t usage =
+        sizeof(ExecutionState) + state->stack.getMemoryUsage();
+    for (const auto &binding : state->addressSpace.objects) {
+      const auto &object = objects.at(binding.second.get());
+      usage += object.size / object.sharers;
+    }
+    state->memoryUsage = usage;
+    total += usage;
+  }
+  return total;
+}
+
+unsigned Executor::spillStates(unsigned count) {
+  std::vector<ExecutionState *> candidates;
+  for (auto state : objectManager->getStates()) {
+    if (!spiller->isSpilled(*state) && !state->mergeGroup &&
+        !seedMap->count(state) &&
+        !(solverPool && solverPool->isPending(state)))
+      candidates.push_back(state);
+  }
+
+  // select states to spill as for early termination
+  unsigned spilled = 0;
+  while (!candidates.empty() && spilled < count) {
+    if (!spiller->spill(*pickStateToEvict(candidates)))
+      break;
+    ++spilled;
+  }
+  return spilled;
+}
+
+void Executor::reloadIfSpilled(ExecutionState &state) {
+  if (spiller && spiller->isSpilled(state))
+    spiller->reload(state);
 }
 
 void Executor::decreaseConfidenceFromStoppedStates(
@@ -4688,8 +5085,13 @@ void Executor::run(ExecutionState *initialState) {
     seed(*initialState);
   }
 
-  searcher =
-      std::make_unique<ForwardOnlySearcher>(constructUserSearcher(*this));
+  if (AsyncSolverWorkers) {
+    solverPool =
+        std::make_unique<AsyncSolverPool>(solver.get(), AsyncSolverWorkers);
+  }
+
+  searcher = std::make_unique<ForwardOnlySearcher>(
+      constructUserSearcher(*this), solverPool.get());
 
   if (targetManager) {
     objectManager->addSubscriber(targetManager.get());
@@ -4705,17 +5107,44 @@ void Executor::run(ExecutionState *initialState) {
 
   objectManager->addSubscriber(searcher.get());
 
+  if ((SpillStates || MaxResidentStates) && !spiller) {
+    spiller = std::make_unique<StateSpiller>(
+        interpreterHandler->getOutputFilename("spilled-states.bin"));
+    objectManager->addSubscriber(spiller.get());
+  }
+  if (spiller)
+    spiller->addBaseline(*initialState);
+
   objectManager->initialUpdate();
 
   // main interpreter loop
   while (!haltExecution && !searcher->empty()) {
     auto action = searcher->selectAction();
     executeAction(action);
+    // The searcher has not seen the results of the previous steps yet, so a
+    // round ends as soon as it proposes a state which was already stepped.
+    for (unsigned worker = 1;
+         worker < StateWorkers && !haltExecution && !searcher->empty();
+         ++worker) {
+      action = searcher->selectAction();
+      if (isa<ForwardAction>(action) &&
+          objectManager->isSteppedInRound(
+              cast<ForwardAction>(action)->state)) {
+        break;
+      }
+      executeAction(action);
+    }
     objectManager->updateSubscribers();
 
     if (!checkMemoryUsage()) {
       objectManager->updateSubscribers();
     }
+
+    if (MaxResidentStates) {
+      auto resident = objectManager->getStates().size() - spiller->size();
+      if (resident > MaxResidentStates)
+        spillStates(resident - MaxResidentStates);
+    }
   }
 
   if (guidanceKind == GuidanceKind::ErrorGuidance) {
@@ -4735,6 +5164,7 @@ void Executor::run(ExecutionState *initialState) {
   doDumpStates();
 
   searcher = nullptr;
+  solverPool = nullptr;
   targetManager = nullptr;
 
   haltExecution = HaltExecution::NotHalt;
@@ -4776,13 +5206,172 @@ static std::string terminationTypeName(StateTerminationType type) {
 void Executor::executeAction(ref<SearcherAction> action) {
   switch (action->getKind()) {
   case SearcherAction::Kind::Forward: {
-    goForward(cast<ForwardAction>(action));
+    auto fa = cast<ForwardAction>(action);
+    reloadIfSpilled(*fa->state);
+    if (checkLazyFork(*fa->state) && !holdForMerge(*fa->state) &&
+        !parkOnBranchQuery(*fa->state))
+      goForward(fa);
+    break;
+  }
+  case SearcherAction::Kind::Resume: {
+    reloadIfSpilled(*cast<ResumeAction>(action)->state);
+    goResume(cast<ResumeAction>(action));
     break;
   }
   }
   timers.invoke();
 }
 
+bool Executor::parkOnBranchQuery(ExecutionState &state) {
+  if (!solverPool || !solverPool->hasCapacity() || seedMap->count(&state))
+    return false;
+
+  KInstruction *ki = state.pc;
+  auto bi = dyn_cast<BranchInst>(ki->inst());
+  if (!bi || bi->isUnconditional())
+    return false;
+
+  ref<Expr> cond = optimizer.optimizeExpr(eval(ki, 0, state).value(), false);
+  if (isa<ConstantExpr>(cond))
+    return false;
+
+  if (!solverPool->submit(state, cond, coreSolverTimeout))
+    return false;
+  searcher->suspend(state);
+  return true;
+}
+
+bool Executor::checkLazyFork(ExecutionState &state) {
+  if (state.uncheckedCondition.isNull())
+    return true;
+  ref<Expr> condition = state.uncheckedCondition;
+  state.uncheckedCondition = nullptr;
+
+  bool mayBeTrue;
+  solver->setTimeout(coreSolverTimeout);
+  bool success = solver->mayBeTrue(state.constraints.cs(), condition,
+                                   mayBeTrue, state.queryMetaData);
+  solver->setTimeout(time::Span());
+  if (!success || !mayBeTrue) {
+    // The state is gone after this round, so it must not be selected again
+    // before the searcher learns about it.
+    if (!objectManager->isSteppedInRound(&state))
+      objectManager->setCurrentState(&state);
+  }
+  if (!success) {
+    terminateStateOnSolverError(state, "Query timed out (lazy fork).");
+    return false;
+  }
+  if (!mayBeTrue) {
+    // The state never existed as far as the eager mode is concerned, so it
+    // is dropped without a test case or a path count.
+    ++stats::lazyForksInfeasible;
+    state.pc = state.prevPC;
+    leaveMergeGroup(state);
+    solver->notifyStateTermination(state.id);
+    objectManager->removeState(&state);
+    return false;
+  }
+  addConstraint(state, condition);
+  return true;
+}
+
+KInstruction *Executor::getMergeExit(KBlock *kb) {
+  auto it = mergeExits.find(kb);
+  if (it != mergeExits.end())
+    return it->second;
+
+  KInstruction *exit = nullptr;
+  if (KBlock *exitBlock = codeGraphInfo->getRegionExit(kb)) {
+    bool mergeable = true;
+    for (KBlock *block : codeGraphInfo->getRegion(kb)) {
+      for (auto &inst : *block->basicBlock()) {
+        if ((isa<CallBase>(inst) && !isa<DbgInfoIntrinsic>(inst)) ||
+            isa<AllocaInst>(inst))
+          mergeable = false;
+      }
+    }
+    if (mergeable) {
+      unsigned begin = 0;
+      while (isa<PHINode>(exitBlock->instructions[begin]->inst()))
+        ++begin;
+      exit = exitBlock->instructions[begin];
+    }
+  }
+  mergeExits.emplace(kb, exit);
+  return exit;
+}
+
+void Executor::openMergeGroup(ExecutionState &trueState,
+                              ExecutionState &falseState) {
+  auto bi = dyn_cast<BranchInst>(trueState.prevPC->inst());
+  if (!bi || bi->isUnconditional())
+    return;
+  KInstruction *exit = getMergeExit(trueState.prevPC->parent);
+  if (!exit)
+    return;
+  auto group = std::make_shared<MergeGroup>(exit, trueState.stack.size());
+  group->live = 2;
+  trueState.mergeGroup = group;
+  falseState.mergeGroup = group;
+}
+
+bool Executor::holdForMerge(ExecutionState &state) {
+  MergeGroup *group = state.mergeGroup.get();
+  if (!group || state.pc != group->exit ||
+      state.stack.size() != group->stackSize)
+    return false;
+
+  if (group->held.size() + 1 < group->live) {
+    group->held.push_back(&state);
+    searcher->suspend(state);
+    return true;
+  }
+  mergeHeldStates(*group, state);
+  return false;
+}
+
+void Executor::mergeHeldStates(MergeGroup &group, ExecutionState &survivor) {
+  // Keeps the group alive until all members are detached from it
+  std::shared_ptr<MergeGroup> keep = survivor.mergeGroup;
+  survivor.mergeGroup.reset();
+  for (auto state : group.held) {
+    if (state == &survivor)
+      continue;
+    state->mergeGroup.reset();
+    if (survivor.merge(*state)) {
+      ++stats::mergedStates;
+      solver->notifyStateTermination(state->id);
+      objectManager->removeState(state);
+    } else {
+      searcher->resume(*state);
+    }
+  }
+  group.held.clear();
+  group.live = 0;
+}
+
+void Executor::leaveMergeGroup(ExecutionState &state) {
+  std::shared_ptr<MergeGroup> group = state.mergeGroup;
+  if (!group)
+    return;
+  state.mergeGroup.reset();
+  --group->live;
+  auto &held = group->held;
+  held.erase(std::remove(held.begin(), held.end(), &state), held.end());
+  if (!held.empty() && held.size() == group->live && !haltExecution) {
+    ExecutionState &survivor = *held.front();
+    mergeHeldStates(*group, survivor);
+    searcher->resume(survivor);
+  }
+}
+
+void Executor::goResume(ref<ResumeAction> action) {
+  resumedBranch = action;
+  goForward(new ForwardAction(action->state));
+  resumedBranch = nullptr;
+}
+
 void Executor::goForward(ref<ForwardAction> action) {
   ref<ForwardAction> fa = cast<ForwardAction>(action);
   objectManager->setCurrentState(fa->state);
@@ -4819,6 +5408,9 @@ void Executor::goForward(ref<ForwardAction> action) {
     maxNewWriteableOSSize = 0;
     maxNewStateStackSize = 0;
 
+    if (JitConcreteBlocks)
+      executeCompiledBlock(state);
+
     KInstruction *ki = state.pc;
     stepInstruction(state);
     executeInstruction(state, ki);
@@ -4938,6 +5530,7 @@ void Executor::terminateState(ExecutionState &state,
 
   interpreterHandler->incPathsExplored();
   state.pc = state.prevPC;
+  leaveMergeGroup(state);
   solver->notifyStateTermination(state.id);
 
   objectManager->removeState(&state);
@@ -4958,6 +5551,7 @@ void Executor::terminateStateOnExit(ExecutionState &state) {
 
 void Executor::terminateStateEarly(ExecutionState &state, const Twine &message,
                                    StateTerminationType reason) {
+  reloadIfSpilled(state);
   if (reason <= StateTerminationType::EARLY) {
     assert(reason > StateTerminationType::EXIT);
     ++stats::terminationEarly;
@@ -4967,6 +5561,10 @@ void Executor::terminateStateEarly(ExecutionState &state, const Twine &message,
         reason == StateTerminationType::MissedAllTargets) &&
        shouldWriteTest(state)) ||
       (AlwaysOutputSeeds && seedMap->count(&state))) {
+    // A state left by a lazy fork may not have been selected yet; it only
+    // gets a test case if its path turns out to be feasible.
+    if (!checkLazyFork(state))
+      return;
     state.clearCoveredNew();
     interpreterHandler->processTestCase(
         state, (message + "\n").str().c_str(),
@@ -5831,7 +6429,7 @@ Executor::allocate(ExecutionState &state, ref<Expr> size, bool isLocal,
     MemoryObject *mo = memory->allocate(arrayConstantSize, isLocal, isGlobal,
                                         false, allocSite, allocationAlignment);
     if (mo && state.isGEPExpr(mo->getBaseExpr())) {
-      state.gepExprBases.erase(mo->getBaseExpr());
+      state.gepExprBases.remove(mo->getBaseExpr());
     }
     return mo;
   }
@@ -5936,7 +6534,7 @@ bool Executor::resolveMemoryObjects(
   unsigned size = bytes;
 
   if (state.isGEPExpr(base)) {
-    size = kmodule->targetData->getTypeStoreSize(state.gepExprBases[base]);
+    size = kmodule->targetData->getTypeStoreSize(state.gepExprBases.at(base));
   }
 
   base = Simplificator::simplifyExpr(state.constraints.cs(), base).simplified;
@@ -5989,10 +6587,14 @@ bool Executor::resolveMemoryObjects(
     if (!onlyLazyInitialize || !mayLazyInitialize) {
       ResolutionList rl;
 
-      solver->setTimeout(coreSolverTimeout);
-      incomplete = state.addressSpace.resolve(state, solver.get(), basePointer,
-                                              rl, 0, coreSolverTimeout);
-      solver->setTimeout(time::Span());
+      if (!resolutionCache.lookup(state, base, rl)) {
+        solver->setTimeout(coreSolverTimeout);
+        incomplete = state.addressSpace.resolve(
+            state, solver.get(), basePointer, rl, 0, coreSolverTimeout);
+        solver->setTimeout(time::Span());
+        if (!incomplete)
+          resolutionCache.insert(state, base, rl);
+      }
 
       for (ResolutionList::iterator i = rl.begin(), ie = rl.end(); i != ie;
            ++i) {
@@ -6299,7 +6901,7 @@ void Executor::executeMemoryOperation(
   if (state->resolvedPointers.count(base) &&
       state->resolvedPointers.at(base).size() == 1) {
     success = true;
-    idFastResult = *state->resolvedPointers[base].begin();
+    idFastResult = *state->resolvedPointers.at(base).begin();
   } else {
     ObjectPair idFastOp;
     solver->setTimeout(coreSolverTimeout);
@@ -6608,7 +7210,7 @@ void Executor::executeMemoryOperation(
     if (unbound->resolvedPointers.count(base) &&
         unbound->resolvedPointers.at(base).size() == 1) {
       uniqueBaseResolved = true;
-      idFastResult = *unbound->resolvedPointers[base].begin();
+      idFastResult = *unbound->resolvedPointers.at(base).begin();
     } else if (auto constBasePointer =
                    dyn_cast<ConstantPointerExpr>(basePointer)) {
       ObjectPair contantResult;
@@ -6702,7 +7304,7 @@ void Executor::lazyInitializeLocalObject(ExecutionState &state, StackFrame &sf,
       kmodule->targetData->getTypeStoreSize(ai->getAllocatedType());
   ref<Expr> size = Expr::createPointer(elementSize);
   if (ai->isArrayAllocation()) {
-    ref<Expr> count = eval(target, 0, state, sf).value;
+    ref<Expr> count = eval(target, 0, state, sf).value();
     count = Expr::createZExtToPointerWidth(count);
     size = MulExpr::create(size, count);
     if (isa<ConstantExpr>(size)) {
@@ -6741,10 +7343,10 @@ void Executor::lazyInitializeLocalObject(ExecutionState &state,
 uint64_t Executor::updateNameVersion(ExecutionState &state,
                                      const std::string &name) {
   uint64_t id = 0;
-  if (state.arrayNames.count(name)) {
-    id = state.arrayNames[name];
+  if (auto version = state.arrayNames.lookup(name)) {
+    id = version->second;
   }
-  state.arrayNames[name] = id + 1;
+  state.arrayNames.replace({name, id + 1});
   return id;
 }
 
@@ -7774,6 +8376,7 @@ void Executor::dumpStates() {
   auto os = interpreterHandler->openOutputFile("states.txt");
 
   if (os) {
+    accountStateMemory();
     for (ExecutionState *es : objectManager->getStates()) {
       *os << "(" << es << ",";
       *os << "[";
@@ -7808,6 +8411,7 @@ void Executor::dumpStates() {
       *os << "'md2u' : " << md2u << ", ";
       *os << "'icnt' : " << icnt << ", ";
       *os << "'CPicnt' : " << cpicnt << ", ";
+      *os << "'memory' : " << es->memoryUsage << ", ";
       *os << "}";
       *os << ")\n";
     }
@@ -15,9 +15,12 @@
 #ifndef KLEE_EXECUTOR_H
 #define KLEE_EXECUTOR_H
 
+#include "AsyncSolverPool.h"
 #include "BidirectionalSearcher.h"
 #include "ExecutionState.h"
+#include "ExternalDispatcher.h"
 #include "ObjectManager.h"
+#include "ResolutionCache.h"
 #include "SeedMap.h"
 #include "TargetedExecutionManager.h"
 #include "UserSearcher.h"
@@ -96,6 +99,7 @@ class Searcher;
 class SeedInfo;
 class SpecialFunctionHandler;
 struct StackFrame;
+class StateSpiller;
 class SymbolicSource;
 class TargetCalculator;
 class TargetManager;
@@ -149,9 +153,39 @@ private:
   std::unique_ptr<IBidirectionalSearcher> searcher;
 
   ExternalDispatcher *externalDispatcher;
+
+  /// Execution counts and native code of basic blocks (see
+  /// --jit-concrete-blocks)
+  struct HotBlock {
+    /// Index of the first instruction after the PHI nodes
+    unsigned begin;
+    unsigned hits = 0;
+    /// Set once the block was compiled, or found not to be compilable
+    bool compiled = false;
+    CompiledBlock code;
+
+    explicit HotBlock(unsigned begin) : begin(begin) {}
+  };
+  std::unordered_map<const KBlock *, HotBlock> hotBlocks;
+  std::vector<uint64_t> blockInputs;
+  std::vector<uint64_t> blockOutputs;
+
   std::unique_ptr<TimingSolver> solver;
   std::unique_ptr<MemoryManager> memory;
 
+  /// Background workers answering branch queries of parked states
+  std::unique_ptr<AsyncSolverPool> solverPool;
+
+  /// Keeps the memory of cold states on disk (see --spill-states)
+  std::unique_ptr<StateSpiller> spiller;
+
+  /// Symbolic pointer resolutions shared by all states
+  ResolutionCache resolutionCache;
+
+  /// The action currently resuming a parked state, if any. Its answer is
+  /// used by fork() instead of querying the solver again.
+  ref<ResumeAction> resumedBranch;
+
   std::unique_ptr<ObjectManager> objectManager;
   StatsTracker *statsTracker;
   TreeStreamWriter *pathWriter, *symPathWriter;
@@ -263,6 +297,17 @@ private:
 
   void executeInstruction(ExecutionState &state, KInstruction *ki);
 
+  /// Executes an integer arithmetic, comparison or cast instruction whose
+  /// operands are all inline constants, without building expressions.
+  /// Returns false if the instruction has to be executed the regular way.
+  bool executeConcreteInstruction(ExecutionState &state, KInstruction *ki);
+
+  /// Runs the straight-line part of the basic block entered by the state
+  /// natively if the block is hot, compilable and only reads registers with
+  /// inline constant values. On success the state is left at the terminator
+  /// of the block.
+  bool executeCompiledBlock(ExecutionState &state);
+
   void seed(ExecutionState &initialState);
   void run(ExecutionState *initialState);
 
@@ -471,40 +516,45 @@ private:
 
   ref<Expr> readArgument(ExecutionState &state, StackFrame &frame,
                          const KFunction *kf, unsigned index) {
-    ref<Expr> arg = frame.locals->at(kf->getArgRegister(index)).value;
+    ref<Expr> arg = frame.locals.at(kf->getArgRegister(index)).value();
     if (!arg) {
       prepareSymbolicArg(state, frame, index);
     }
-    return frame.locals->at(kf->getArgRegister(index)).value;
+    return frame.locals.at(kf->getArgRegister(index)).value();
   }
 
   ref<Expr> readDest(ExecutionState &state, StackFrame &frame,
                      const KInstruction *target) {
     unsigned index = target->getDest();
-    ref<Expr> reg = frame.locals->at(index).value;
+    ref<Expr> reg = frame.locals.at(index).value();
     if (!reg) {
       prepareSymbolicRegister(state, frame, index);
     }
-    return frame.locals->at(index).value;
+    return frame.locals.at(index).value();
   }
 
   const Cell &getArgumentCell(const StackFrame &frame, const KFunction *kf,
                               unsigned index) {
-    return frame.locals->at(kf->getArgRegister(index));
+    return frame.locals.at(kf->getArgRegister(index));
   }
 
   const Cell &getDestCell(const StackFrame &frame, const KInstruction *target) {
-    return frame.locals->at(target->getDest());
+    return frame.locals.at(target->getDest());
   }
 
   void setArgumentCell(StackFrame &frame, const KFunction *kf, unsigned index,
                        ref<Expr> value) {
-    return frame.locals->set(kf->getArgRegister(index), Cell(value));
+    return frame.locals.set(kf->getArgRegister(index), Cell(value));
   }
 
   void setDestCell(StackFrame &frame, const KInstruction *target,
                    ref<Expr> value) {
-    return frame.locals->set(target->getDest(), Cell(value));
+    return frame.locals.set(target->getDest(), Cell(value));
+  }
+
+  void setDestCell(StackFrame &frame, const KInstruction *target,
+                   const Cell &value) {
+    return frame.locals.set(target->getDest(), value);
   }
 
   const Cell &eval(const KInstruction *ki, unsigned index,
@@ -539,6 +589,9 @@ private:
   void bindLocal(const KInstruction *target, ExecutionState &state,
                  ref<Expr> value);
 
+  void bindLocal(const KInstruction *target, ExecutionState &state,
+                 const Cell &value);
+
   void bindArgument(KFunction *kf, unsigned index, ExecutionState &state,
                     ref<Expr> value);
 
@@ -714,6 +767,21 @@ private:
   /// terminated)
   bool checkMemoryUsage();
 
+  /// Removes the next state to spill or terminate under memory pressure
+  /// from `candidates` and returns it (see --evict-largest-states)
+  ExecutionState *pickStateToEvict(std::vector<ExecutionState *> &candidates);
+
+  /// Spills up to `count` states which are not waiting for a merge or a
+  /// solver query. Returns the number of states spilled.
+  unsigned spillStates(unsigned count);
+
+  /// Reads `state` back from the spill file before it is used
+  void reloadIfSpilled(ExecutionState &state);
+
+  /// Attributes the memory of the stack and the bound objects to every
+  /// state (see ExecutionState::memoryUsage) and returns the total.
+  std::uint64_t accountStateMemory();
+
   /// check if branching/forking into N branches is allowed
   bool branchingPermitted(ExecutionState &state, unsigned N);
 
@@ -726,6 +794,38 @@ private:
 
   void executeAction(ref<SearcherAction> action);
   void goForward(ref<ForwardAction> action);
+  void goResume(ref<ResumeAction> action);
+
+  /// Hands the feasibility query of the conditional branch the state is
+  /// about to execute to the solver pool and parks the state meanwhile.
+  /// Returns false if the state should be stepped right away.
+  bool parkOnBranchQuery(ExecutionState &state);
+
+  /// Checks the branch condition left unchecked by a lazy fork and adds it
+  /// to the path constraints. Returns false if the state was terminated
+  /// because the condition is infeasible or the query failed.
+  bool checkLazyFork(ExecutionState &state);
+
+  /// First instruction after the PHI nodes of the exit of the mergeable
+  /// region starting at each block, or nullptr (see --merge-regions)
+  std::unordered_map<KBlock *, KInstruction *> mergeExits;
+
+  KInstruction *getMergeExit(KBlock *kb);
+
+  /// Makes the two states forked at a branch wait for each other at the
+  /// exit of the region the branch starts, if it has one.
+  void openMergeGroup(ExecutionState &trueState, ExecutionState &falseState);
+
+  /// Holds the state if it reached the exit of its merge region and other
+  /// members of its group are still running. Once the last member arrives,
+  /// merges the group into it. Returns true if the state was held.
+  bool holdForMerge(ExecutionState &state);
+
+  /// Merges the held members of the group into `survivor`.
+  void mergeHeldStates(MergeGroup &group, ExecutionState &survivor);
+
+  /// Removes a terminating state from its merge group.
+  void leaveMergeGroup(ExecutionState &state);
 
   const KInstruction *getKInst(const llvm::Instruction *ints) const;
   const KBlock *getKBlock(const llvm::BasicBlock *bb) const;
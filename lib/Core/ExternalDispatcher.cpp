@@ -12,6 +12,7 @@
 #include "CoreStats.h"
 #include "klee/Config/Version.h"
 #include "klee/Module/KCallable.h"
+#include "klee/Module/KInstruction.h"
 #include "klee/Module/KModule.h"
 
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
@@ -70,6 +71,7 @@ public:
   bool executeCall(KCallable *callable, llvm::Instruction *i, uint64_t *args,
                    int roundingMode);
   void *resolveSymbol(const std::string &name);
+  bool compileBlock(const KBlock *block, unsigned begin, CompiledBlock &result);
   int getLastErrno();
   void setLastErrno(int newErrno);
 };
@@ -379,6 +381,162 @@ Function *ExternalDispatcherImpl::createDispatcher(KCallable *target,
   return dispatcher;
 }
 
+static bool isCompilableType(Type *type) {
+  return type->isIntegerTy() && type->getIntegerBitWidth() <= 64;
+}
+
+static bool isCompilable(Instruction *inst) {
+  switch (inst->getOpcode()) {
+  case Instruction::Add:
+  case Instruction::Sub:
+  case Instruction::Mul:
+  case Instruction::UDiv:
+  case Instruction::SDiv:
+  case Instruction::URem:
+  case Instruction::SRem:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+  case Instruction::ICmp:
+  case Instruction::Trunc:
+  case Instruction::ZExt:
+  case Instruction::SExt:
+  case Instruction::Select:
+    break;
+  default:
+    return false;
+  }
+  if (!isCompilableType(inst->getType()))
+    return false;
+  for (Value *operand : inst->operands())
+    if (!isCompilableType(operand->getType()))
+      return false;
+  return true;
+}
+
+bool ExternalDispatcherImpl::compileBlock(const KBlock *block, unsigned begin,
+                                          CompiledBlock &result) {
+  unsigned end = block->getNumInstructions() - 1;
+  if (begin >= end)
+    return false;
+  for (unsigned i = begin; i < end; ++i)
+    if (!isCompilable(block->instructions[i]->inst()))
+      return false;
+
+  Module *blockModule = new Module(getFreshModuleID(), ctx);
+  Type *i64Ty = Type::getInt64Ty(ctx);
+  Type *i64PtrTy = PointerType::getUnqual(i64Ty);
+  std::string fnName = "block_" + blockModule->getModuleIdentifier();
+  Function *fn = Function::Create(
+      FunctionType::get(Type::getInt1Ty(ctx), {i64PtrTy, i64PtrTy}, false),
+      GlobalVariable::ExternalLinkage, fnName, blockModule);
+  Value *inputs = fn->getArg(0);
+  Value *outputs = fn->getArg(1);
+
+  BasicBlock *entry = BasicBlock::Create(ctx, "entry", fn);
+  BasicBlock *bail = BasicBlock::Create(ctx, "bail", fn);
+  ReturnInst::Create(ctx, ConstantInt::getFalse(ctx), bail);
+  IRBuilder<> Builder(entry);
+
+  // Values are computed first and written out once the whole block is known
+  // not to bail out, so that a bail-out has no effect.
+  std::map<unsigned, Value *> inputValues;
+  std::map<Value *, Value *> computed;
+  std::vector<Value *> results;
+  CompiledBlock compiled;
+  compiled.begin = begin;
+
+  auto bailIf = [&](Value *cond) {
+    BasicBlock *next = BasicBlock::Create(ctx, "", fn);
+    Builder.CreateCondBr(cond, bail, next);
+    Builder.SetInsertPoint(next);
+  };
+
+  for (unsigned i = begin; i < end; ++i) {
+    KInstruction *ki = block->instructions[i];
+    Instruction *inst = ki->inst();
+    Instruction *clone = inst->clone();
+    clone->dropPoisonGeneratingFlags();
+
+    for (unsigned j = 0, e = inst->getNumOperands(); j < e; ++j) {
+      Value *operand = inst->getOperand(j);
+      auto it = computed.find(operand);
+      if (it != computed.end()) {
+        clone->setOperand(j, it->second);
+      } else if (isa<ConstantInt>(operand)) {
+        // Constants are shared by all modules of the context.
+      } else if (ki->operands[j] >= 0 &&
+                 (isa<Instruction>(operand) || isa<Argument>(operand))) {
+        unsigned reg = ki->operands[j];
+        Value *&input = inputValues[reg];
+        if (!input) {
+          Value *slot =
+              Builder.CreateConstGEP1_32(i64Ty, inputs, compiled.inputs.size());
+          input = Builder.CreateLoad(i64Ty, slot);
+          compiled.inputs.push_back(reg);
+        }
+        clone->setOperand(j, Builder.CreateTrunc(input, operand->getType()));
+      } else {
+        clone->deleteValue();
+        delete blockModule;
+        return false;
+      }
+    }
+
+    // Leave the cases the interpreter reports or defines differently from
+    // the native instructions to the interpreter.
+    Value *rhs = clone->getNumOperands() == 2 ? clone->getOperand(1) : nullptr;
+    switch (inst->getOpcode()) {
+    case Instruction::SDiv:
+    case Instruction::SRem: {
+      Type *type = inst->getType();
+      bailIf(Builder.CreateAnd(
+          Builder.CreateICmpEQ(clone->getOperand(0),
+                               ConstantInt::get(ctx, APInt::getSignedMinValue(
+                                                         type->getIntegerBitWidth()))),
+          Builder.CreateICmpEQ(rhs, ConstantInt::getSigned(type, -1))));
+      LLVM_FALLTHROUGH;
+    }
+    case Instruction::UDiv:
+    case Instruction::URem:
+      bailIf(Builder.CreateIsNull(rhs));
+      break;
+    case Instruction::Shl:
+    case Instruction::LShr:
+    case Instruction::AShr:
+      bailIf(Builder.CreateICmpUGE(
+          rhs, ConstantInt::get(inst->getType(),
+                                inst->getType()->getIntegerBitWidth())));
+      break;
+    default:
+      break;
+    }
+
+    Builder.Insert(clone);
+    computed[inst] = clone;
+    results.push_back(clone);
+    compiled.outputs.emplace_back(ki->getDest(),
+                                  inst->getType()->getIntegerBitWidth());
+  }
+
+  for (unsigned i = 0; i < results.size(); ++i)
+    Builder.CreateStore(Builder.CreateZExt(results[i], i64Ty),
+                        Builder.CreateConstGEP1_32(i64Ty, outputs, i));
+  Builder.CreateRet(ConstantInt::getTrue(ctx));
+
+  executionEngine->addModule(std::unique_ptr<Module>(blockModule));
+  uint64_t fnAddr = executionEngine->getFunctionAddress(fnName);
+  executionEngine->finalizeObject();
+  assert(fnAddr && "failed to get function address");
+  compiled.function = reinterpret_cast<CompiledBlock::Function>(fnAddr);
+  result = std::move(compiled);
+  ++stats::jitCompiledBlocks;
+  return true;
+}
+
 int ExternalDispatcherImpl::getLastErrno() { return lastErrno; }
 void ExternalDispatcherImpl::setLastErrno(int newErrno) {
   lastErrno = newErrno;
@@ -398,6 +556,11 @@ void *ExternalDispatcher::resolveSymbol(const std::string &name) {
   return impl->resolveSymbol(name);
 }
 
+bool ExternalDispatcher::compileBlock(const KBlock *block, unsigned begin,
+                                      CompiledBlock &result) {
+  return impl->compileBlock(block, begin, result);
+}
+
 int ExternalDispatcher::getLastErrno() { return impl->getLastErrno(); }
 void ExternalDispatcher::setLastErrno(int newErrno) {
   impl->setLastErrno(newErrno);
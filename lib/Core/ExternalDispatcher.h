@@ -12,6 +12,8 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace llvm {
 class Instruction;
@@ -20,7 +22,26 @@ class LLVMContext;
 
 namespace klee {
 class ExternalDispatcherImpl;
+struct KBlock;
 struct KCallable;
+
+/// The straight-line part of a basic block compiled to native code. The
+/// function reads the values of `inputs` from its first argument and writes
+/// the values of `outputs` to its second one, in order. It returns false
+/// without writing anything if the block has to be left to the interpreter.
+struct CompiledBlock {
+  typedef bool (*Function)(const uint64_t *inputs, uint64_t *outputs);
+
+  Function function = nullptr;
+  /// Registers read by the block.
+  std::vector<unsigned> inputs;
+  /// Registers written by the block, with the bit width of their values.
+  std::vector<std::pair<unsigned, unsigned>> outputs;
+  /// Index of the first compiled instruction. The block is compiled up to,
+  /// but not including, its terminator.
+  unsigned begin = 0;
+};
+
 class ExternalDispatcher {
 private:
   ExternalDispatcherImpl *impl;
@@ -37,6 +58,12 @@ public:
                    int roundingMode);
   void *resolveSymbol(const std::string &name);
 
+  /// Compiles the instructions of `block` from index `begin` up to its
+  /// terminator. Only blocks of integer arithmetic, comparisons, casts and
+  /// selects on values of at most 64 bits can be compiled. Returns false if
+  /// the block contains anything else.
+  bool compileBlock(const KBlock *block, unsigned begin, CompiledBlock &result);
+
   int getLastErrno();
   void setLastErrno(int newErrno);
 };
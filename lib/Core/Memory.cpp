@@ -10,11 +10,13 @@
 #include "Memory.h"
 
 #include "ConstructStorage.h"
+#include "CoreStats.h"
 #include "ExecutionState.h"
 #include "Executor.h"
 #include "MemoryManager.h"
 #include "klee/ADT/Bits.h"
 #include "klee/ADT/Ref.h"
+#include "klee/ADT/SlabAllocator.h"
 #include "klee/ADT/SparseStorage.h"
 #include "klee/Core/Context.h"
 
@@ -33,6 +35,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <vector>
 
 namespace klee {
 llvm::cl::opt<MemoryType> MemoryBackend(
@@ -69,6 +72,24 @@ MemoryObject::~MemoryObject() {
     parent->markFreed(this);
 }
 
+static SlabAllocator &getMemoryObjectAllocator() {
+  // Never destroyed, as objects may outlive static destructors
+  static SlabAllocator *allocator = new SlabAllocator();
+  return *allocator;
+}
+
+void *MemoryObject::operator new(size_t size) {
+  SlabAllocator &allocator = getMemoryObjectAllocator();
+  size_t slabBytes = allocator.getSlabBytes();
+  void *ptr = allocator.allocate(size);
+  stats::memoryObjectSlabBytes += allocator.getSlabBytes() - slabBytes;
+  return ptr;
+}
+
+void MemoryObject::operator delete(void *ptr, size_t size) {
+  getMemoryObjectAllocator().deallocate(ptr, size);
+}
+
 std::string MemoryObject::getAllocInfo() const {
   std::string result;
   llvm::raw_string_ostream info(result);
@@ -115,6 +136,12 @@ ObjectState::ObjectState(const MemoryObject *mo)
   baseOS.initializeToZero();
 }
 
+ObjectState::ObjectState(const MemoryObject *mo, ref<Expr> size,
+                         ObjectStage &&valueOS, ObjectStage &&baseOS)
+    : copyOnWriteOwner(0), object(mo), valueOS(std::move(valueOS)),
+      baseOS(std::move(baseOS)), lastUpdate(nullptr), size(size),
+      readOnly(false) {}
+
 ObjectState::ObjectState(const ObjectState &os)
     : copyOnWriteOwner(0), object(os.object), valueOS(os.valueOS),
       baseOS(os.baseOS), lastUpdate(os.lastUpdate), size(os.size),
@@ -276,6 +303,60 @@ void ObjectState::write(ref<const ObjectState> os) {
   lastUpdate = os->lastUpdate;
 }
 
+void ObjectState::merge(ref<Expr> condition, const ObjectState &other) {
+  unsigned bytes = cast<ConstantExpr>(size)->getZExtValue();
+  bool changed = false;
+  for (unsigned i = 0; i < bytes; ++i) {
+    ref<Expr> value = valueOS.readWidth(i);
+    ref<Expr> otherValue = other.valueOS.readWidth(i);
+    if (value != otherValue) {
+      valueOS.writeWidth(i, SelectExpr::create(condition, value, otherValue));
+      changed = true;
+    }
+    ref<Expr> base = baseOS.readWidth(i);
+    ref<Expr> otherBase = other.baseOS.readWidth(i);
+    if (base != otherBase) {
+      baseOS.writeWidth(i, SelectExpr::create(condition, base, otherBase));
+      changed = true;
+    }
+  }
+  if (changed) {
+    wasWritten = true;
+    lastUpdate = nullptr;
+  }
+}
+
+void ObjectState::copyBytes(unsigned offset, const ObjectState &src,
+                            unsigned srcOffset, unsigned count) {
+  // Read the source first, so that overlapping ranges of the same object
+  // are copied as memmove does
+  std::vector<ref<Expr>> values, bases;
+  values.reserve(count);
+  bases.reserve(count);
+  for (unsigned i = 0; i < count; ++i) {
+    values.push_back(src.valueOS.readWidth(srcOffset + i));
+    bases.push_back(src.baseOS.readWidth(srcOffset + i));
+  }
+  for (unsigned i = 0; i < count; ++i) {
+    valueOS.writeWidth(offset + i, values[i]);
+    baseOS.writeWidth(offset + i, bases[i]);
+  }
+  wasWritten = true;
+  lastUpdate = nullptr;
+}
+
+void ObjectState::fillBytes(unsigned offset, ref<Expr> value,
+                            unsigned count) {
+  assert(value->getWidth() == Expr::Int8 && "Invalid fill width!");
+  ref<Expr> base = ConstantExpr::create(0, Context::get().getPointerWidth());
+  for (unsigned i = 0; i < count; ++i) {
+    valueOS.writeWidth(offset + i, value);
+    baseOS.writeWidth(offset + i, base);
+  }
+  wasWritten = true;
+  lastUpdate = nullptr;
+}
+
 /***/
 
 ref<Expr> ObjectState::read(ref<Expr> offset, Expr::Width width) const {
@@ -532,6 +613,11 @@ ObjectStage::ObjectStage(const ObjectStage &os)
       unflushedMask(os.unflushedMask->clone()), updates(os.updates),
       size(os.size), safeRead(os.safeRead), width(os.width) {}
 
+size_t ObjectStage::getMemoryUsage() const {
+  return knownSymbolics->storage().getMemoryUsage() +
+         unflushedMask->storage().getMemoryUsage();
+}
+
 /***/
 
 const UpdateList &ObjectStage::getUpdates() const {
@@ -126,6 +126,11 @@ public:
 
   ~MemoryObject();
 
+  /// Memory objects are allocated from slabs, as programs allocate and free
+  /// many of them
+  static void *operator new(size_t size);
+  static void operator delete(void *ptr, size_t size);
+
   /// Get an identifying string for this allocation.
   std::string getAllocInfo() const;
 
@@ -212,6 +217,8 @@ public:
 
 class ObjectStage {
 private:
+  friend class StateSpiller;
+
   using storage_ty = SparseStorage<ref<Expr>, OptionalRefEq<Expr>>;
   using bool_storage_ty = SparseStorage<bool>;
   /// knownSymbolics[byte] holds the expression for byte,
@@ -236,6 +243,7 @@ public:
               Expr::Width width = Expr::Int8);
 
   ObjectStage(const ObjectStage &os);
+  ObjectStage(ObjectStage &&os) = default;
   ~ObjectStage() = default;
 
   ref<Expr> readWidth(unsigned offset) const;
@@ -253,6 +261,12 @@ public:
   size_t getSparseStorageEntries() {
     return knownSymbolics->storage().size() + unflushedMask->storage().size();
   }
+
+  /// Estimates the bytes allocated for the stored bytes of this stage. The
+  /// update list is not included, as its nodes are shared with the objects
+  /// this one was copied from.
+  size_t getMemoryUsage() const;
+
   void initializeToZero();
 
 private:
@@ -267,6 +281,7 @@ private:
 class ObjectState {
 private:
   friend class AddressSpace;
+  friend class StateSpiller;
   friend class ref<ObjectState>;
   friend class ref<const ObjectState>;
 
@@ -307,6 +322,12 @@ public:
     return valueOS.getSparseStorageEntries() + baseOS.getSparseStorageEntries();
   }
 
+  /// Estimates the bytes allocated for this object state
+  size_t getMemoryUsage() const {
+    return sizeof(ObjectState) + valueOS.getMemoryUsage() +
+           baseOS.getMemoryUsage();
+  }
+
   void swapObjectHack(MemoryObject *mo) { object = mo; }
 
   ref<Expr> read(ref<Expr> offset, Expr::Width width) const;
@@ -323,6 +344,19 @@ public:
   void write(ref<Expr> offset, ref<Expr> value);
   void write(ref<const ObjectState> os);
 
+  /// Keeps the bytes of this object where `condition` holds and takes the
+  /// bytes of `other` elsewhere. Both objects must have the same constant
+  /// size.
+  void merge(ref<Expr> condition, const ObjectState &other);
+
+  /// Copies `count` bytes of `src` starting at `srcOffset` to this object
+  /// starting at `offset`. The ranges may overlap when `src` is this object.
+  void copyBytes(unsigned offset, const ObjectState &src, unsigned srcOffset,
+                 unsigned count);
+
+  /// Writes the byte `value` to `count` bytes starting at `offset`
+  void fillBytes(unsigned offset, ref<Expr> value, unsigned count);
+
   void write8(unsigned offset, uint8_t value);
   void write16(unsigned offset, uint16_t value);
   void write32(unsigned offset, uint32_t value);
@@ -330,6 +364,9 @@ public:
   void print() const;
 
 private:
+  ObjectState(const MemoryObject *mo, ref<Expr> size, ObjectStage &&valueOS,
+              ObjectStage &&baseOS);
+
   ref<Expr> read8(ref<Expr> offset) const;
   ref<Expr> readValue8(ref<Expr> offset) const;
   ref<Expr> readBase8(ref<Expr> offset) const;
@@ -45,6 +45,13 @@ llvm::cl::opt<unsigned> DeterministicAllocationSize(
         "Preallocated memory for deterministic allocation in MB (default=100)"),
     llvm::cl::init(100), llvm::cl::cat(MemoryCat));
 
+llvm::cl::opt<unsigned long long> DeterministicQuarantineSize(
+    "allocate-determ-quarantine",
+    llvm::cl::desc("Bytes of freed deterministic allocations, redzones "
+                   "included, kept from reuse to catch dangling pointers. "
+                   "The oldest are reused first (default=1048576)"),
+    llvm::cl::init(1 << 20), llvm::cl::cat(MemoryCat));
+
 llvm::cl::opt<bool> NullOnZeroMalloc(
     "return-null-on-zero-malloc",
     llvm::cl::desc("Returns NULL if malloc(0) is called (default=false)"),
@@ -154,21 +161,28 @@ MemoryObject *MemoryManager::allocate(ref<Expr> size, bool isLocal,
     assert(sizeExpr);
     auto moSize = sizeExpr->getZExtValue();
     if (DeterministicAllocation) {
-      address =
-          llvm::alignTo((uint64_t)nextFreeSlot + alignment - 1, alignment);
-
       // Handle the case of 0-sized allocations as 1-byte allocations.
       // This way, we make sure we have this allocation between its own red
       // zones
       size_t alloc_size = std::max(moSize, (uint64_t)1);
-      if ((char *)address + alloc_size < deterministicSpace + spaceSize) {
-        nextFreeSlot = (char *)address + alloc_size + RedzoneSize;
+      address = reuseSlot(alloc_size, alignment);
+      if (address) {
+        ++stats::reusedAllocations;
       } else {
-        klee_warning_once(0,
-                          "Couldn't allocate %" PRIu64
-                          " bytes. Not enough deterministic space left.",
-                          moSize);
-        address = 0;
+        address =
+            llvm::alignTo((uint64_t)nextFreeSlot + alignment - 1, alignment);
+        if ((char *)address + alloc_size < deterministicSpace + spaceSize) {
+          char *slotEnd = (char *)address + alloc_size + RedzoneSize;
+          liveSlots[address] = {(uint64_t)nextFreeSlot,
+                                (uint64_t)(slotEnd - nextFreeSlot)};
+          nextFreeSlot = slotEnd;
+        } else {
+          klee_warning_once(0,
+                            "Couldn't allocate %" PRIu64
+                            " bytes. Not enough deterministic space left.",
+                            moSize);
+          address = 0;
+        }
       }
     } else {
       // Use malloc for the standard case
@@ -229,16 +243,61 @@ MemoryObject *MemoryManager::allocateFixed(uint64_t address, uint64_t size,
 
 void MemoryManager::markFreed(MemoryObject *mo) {
   if (objects.find(mo) != objects.end()) {
-    if (!mo->isFixed && !DeterministicAllocation) {
+    if (!mo->isFixed) {
       if (ref<ConstantExpr> arrayConstantAddress =
               dyn_cast<ConstantExpr>(mo->getBaseExpr())) {
-        free((void *)arrayConstantAddress->getZExtValue());
+        if (DeterministicAllocation)
+          releaseSlot(arrayConstantAddress->getZExtValue());
+        else
+          free((void *)arrayConstantAddress->getZExtValue());
       }
     }
     objects.erase(mo);
   }
 }
 
+uint64_t MemoryManager::reuseSlot(uint64_t size, size_t alignment) {
+  uint64_t needed = size + RedzoneSize;
+  // Objects are placed in a slot as in fresh space, which pads them by up to
+  // 2 * alignment - 1 bytes. Slots of the first class may be too small, the
+  // ones of the last class fit whatever the alignment of their start
+  unsigned first = llvm::Log2_64(needed);
+  unsigned last = llvm::Log2_64_Ceil(needed + 2 * alignment - 1);
+  for (unsigned sizeClass = first;
+       sizeClass <= last && sizeClass < freeSlots.size(); ++sizeClass) {
+    std::vector<Slot> &slots = freeSlots[sizeClass];
+    if (slots.empty())
+      continue;
+    Slot slot = slots.back();
+    uint64_t address = llvm::alignTo(slot.start + alignment - 1, alignment);
+    if (address + needed > slot.start + slot.size)
+      continue;
+    slots.pop_back();
+    liveSlots[address] = slot;
+    return address;
+  }
+  return 0;
+}
+
+void MemoryManager::releaseSlot(uint64_t address) {
+  auto it = liveSlots.find(address);
+  if (it == liveSlots.end())
+    return;
+  quarantine.push_back(it->second);
+  quarantinedBytes += it->second.size;
+  liveSlots.erase(it);
+
+  while (quarantinedBytes > DeterministicQuarantineSize) {
+    Slot slot = quarantine.front();
+    quarantine.pop_front();
+    quarantinedBytes -= slot.size;
+    unsigned sizeClass = llvm::Log2_64(slot.size);
+    if (sizeClass >= freeSlots.size())
+      freeSlots.resize(sizeClass + 1);
+    freeSlots[sizeClass].push_back(slot);
+  }
+}
+
 size_t MemoryManager::getUsedDeterministicSize() {
   return nextFreeSlot - deterministicSpace;
 }
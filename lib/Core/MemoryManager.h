@@ -14,7 +14,10 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <set>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace llvm {
 class Value;
@@ -28,13 +31,36 @@ typedef uint64_t IDType;
 
 class MemoryManager {
 private:
-  typedef std::set<MemoryObject *> objects_ty;
+  typedef std::unordered_set<MemoryObject *> objects_ty;
   objects_ty objects;
 
   char *deterministicSpace;
   char *nextFreeSlot;
   size_t spaceSize;
 
+  /// A range of the deterministic space holding an object and its redzone
+  struct Slot {
+    uint64_t start;
+    uint64_t size;
+  };
+
+  /// slots of the live deterministic objects, by object address
+  std::unordered_map<uint64_t, Slot> liveSlots;
+
+  /// slots of freed objects, oldest first, which are not reused yet so that
+  /// dangling pointers to them do not reach new objects
+  std::deque<Slot> quarantine;
+  uint64_t quarantinedBytes = 0;
+
+  /// reusable slots of freed objects; freeSlots[i] holds slots of at least
+  /// 2^i bytes and less than 2^(i+1) bytes
+  std::vector<std::vector<Slot>> freeSlots;
+
+  /// Returns the address of a reused slot for `size` bytes, or 0 if no
+  /// freed slot fits
+  uint64_t reuseSlot(uint64_t size, size_t alignment);
+  void releaseSlot(uint64_t address);
+
 public:
   MemoryManager();
   ~MemoryManager();
@@ -6,6 +6,8 @@
 
 #include "klee/Module/KModule.h"
 
+#include <algorithm>
+
 using namespace llvm;
 using namespace klee;
 
@@ -23,11 +25,16 @@ void ObjectManager::addInitialState(ExecutionState *state) {
 }
 
 void ObjectManager::setCurrentState(ExecutionState *_current) {
-  assert(current == nullptr);
-  current = _current;
+  assert(!isSteppedInRound(_current));
+  currentStates.push_back(_current);
   statesUpdated = true;
 }
 
+bool ObjectManager::isSteppedInRound(ExecutionState *state) const {
+  return std::find(currentStates.begin(), currentStates.end(), state) !=
+         currentStates.end();
+}
+
 ExecutionState *ObjectManager::branchState(ExecutionState *state,
                                            BranchType reason) {
   assert(statesUpdated);
@@ -51,6 +58,22 @@ void ObjectManager::removeState(ExecutionState *state) {
 
 void ObjectManager::updateSubscribers() {
   if (statesUpdated) {
+    // Every state but the last one stepped in this round is reported on its
+    // own, without additions or removals; the last event carries the whole
+    // batch of added and removed states.
+    static const std::vector<ExecutionState *> noStates;
+    ExecutionState *current = nullptr;
+    for (auto state : currentStates) {
+      if (current && std::find(removedStates.begin(), removedStates.end(),
+                               current) == removedStates.end()) {
+        ref<Event> e = new States(current, noStates, noStates);
+        for (auto s : subscribers) {
+          s->update(e);
+        }
+      }
+      current = state;
+    }
+
     ref<Event> e = new States(current, addedStates, removedStates);
     for (auto s : subscribers) {
       s->update(e);
@@ -66,7 +89,7 @@ void ObjectManager::updateSubscribers() {
       delete state;
     }
 
-    current = nullptr;
+    currentStates.clear();
     addedStates.clear();
     removedStates.clear();
     statesUpdated = false;
@@ -55,6 +55,7 @@ public:
   void addInitialState(ExecutionState *state);
 
   void setCurrentState(ExecutionState *_current);
+  bool isSteppedInRound(ExecutionState *state) const;
 
   ExecutionState *branchState(ExecutionState *state, BranchType reason);
   void removeState(ExecutionState *state);
@@ -76,7 +77,9 @@ public:
 
   bool statesUpdated = false;
 
-  ExecutionState *current = nullptr;
+  // States stepped since the last update. With a single worker this holds at
+  // most one state; in batched mode every worker contributes its own state.
+  std::vector<ExecutionState *> currentStates;
   std::vector<ExecutionState *> addedStates;
   std::vector<ExecutionState *> removedStates;
 };
@@ -0,0 +1,97 @@
+//===-- ResolutionCache.cpp -----------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ResolutionCache.h"
+
+#include "CoreStats.h"
+#include "ExecutionState.h"
+#include "Memory.h"
+
+#include "klee/Expr/Constraints.h"
+#include "klee/Expr/IndependentSet.h"
+
+#include "llvm/Support/CommandLine.h"
+
+using namespace klee;
+
+namespace klee {
+extern llvm::cl::OptionCategory PointerResolvingCat;
+} // namespace klee
+
+namespace {
+llvm::cl::opt<unsigned> ResolutionCacheSize(
+    "resolution-cache-size", llvm::cl::init(4096),
+    llvm::cl::desc("Number of symbolic pointer resolutions shared by all "
+                   "states, the cache is emptied when it gets larger "
+                   "(0=off, default=4096)"),
+    llvm::cl::cat(PointerResolvingCat));
+} // namespace
+
+bool ResolutionCache::getKey(const ExecutionState &state, ref<Expr> base,
+                             Key &key) const {
+  if (ResolutionCacheSize == 0 || isa<ConstantExpr>(base) ||
+      state.addressSpace.complete || state.addressSpace.hasSymbolicObjects())
+    return false;
+
+  std::vector<ref<const IndependentConstraintSet>> factors;
+  state.constraints.cs().getAllDependentConstraintsSets(base, factors);
+  constraints_ty constraints;
+  for (const auto &factor : factors) {
+    if (!factor->symcretes.empty())
+      return false;
+    for (const auto &constraint : factor->exprs)
+      constraints.insert(constraint);
+  }
+
+  key.base = base;
+  key.epoch = state.addressSpace.getEpoch();
+  key.constraints.assign(constraints.begin(), constraints.end());
+  key.hash = base->hash() ^ static_cast<unsigned>(key.epoch * 0x9e3779b9);
+  for (const auto &constraint : key.constraints)
+    key.hash = key.hash * Expr::MAGIC_HASH_CONSTANT + constraint->hash();
+  return true;
+}
+
+bool ResolutionCache::lookup(const ExecutionState &state, ref<Expr> base,
+                             ResolutionList &rl) {
+  Key key;
+  if (!getKey(state, base, key))
+    return false;
+  auto it = cache.find(key);
+  if (it == cache.end()) {
+    ++stats::resolutionCacheMisses;
+    return false;
+  }
+
+  ResolutionList found;
+  for (const MemoryObject *mo : it->second) {
+    ObjectPair op = state.addressSpace.findObject(mo);
+    if (!op.first) {
+      ++stats::resolutionCacheMisses;
+      return false;
+    }
+    found.push_back(op);
+  }
+  ++stats::resolutionCacheHits;
+  rl.insert(rl.end(), found.begin(), found.end());
+  return true;
+}
+
+void ResolutionCache::insert(const ExecutionState &state, ref<Expr> base,
+                             const ResolutionList &rl) {
+  Key key;
+  if (!getKey(state, base, key))
+    return;
+  if (cache.size() >= ResolutionCacheSize)
+    cache.clear();
+  std::vector<const MemoryObject *> &objects = cache[key];
+  objects.clear();
+  for (const auto &op : rl)
+    objects.push_back(op.first);
+}
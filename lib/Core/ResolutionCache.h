@@ -0,0 +1,72 @@
+//===-- ResolutionCache.h ---------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_RESOLUTIONCACHE_H
+#define KLEE_RESOLUTIONCACHE_H
+
+#include "AddressSpace.h"
+
+#include "klee/ADT/Ref.h"
+#include "klee/Expr/Expr.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace klee {
+class ExecutionState;
+
+/// Remembers the objects symbolic pointers resolved to, for all states at
+/// once. Siblings made by a fork share their address space and most of
+/// their constraints, so they would otherwise send the same resolution
+/// queries to the solver.
+///
+/// A resolution is keyed on the base of the pointer, the epoch of the
+/// address space and the constraints the base depends on, which are all the
+/// solver looks at when resolving it. Address spaces with objects of a
+/// symbolic address or size, and bases depending on symcretes, are not
+/// cached, as their resolution depends on further constraints.
+class ResolutionCache {
+  struct Key {
+    ref<Expr> base;
+    uint64_t epoch;
+    std::vector<ref<Expr>> constraints;
+    unsigned hash;
+
+    bool operator==(const Key &b) const {
+      return hash == b.hash && epoch == b.epoch && base == b.base &&
+             constraints == b.constraints;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const { return key.hash; }
+  };
+
+  /// The objects are only looked up in address spaces of the epoch of the
+  /// entry, which hold them, so they need not be kept alive here
+  std::unordered_map<Key, std::vector<const MemoryObject *>, KeyHash> cache;
+
+  /// Returns false iff the resolution of `base` in `state` may not be cached
+  bool getKey(const ExecutionState &state, ref<Expr> base, Key &key) const;
+
+public:
+  /// Fills `rl` with the objects `base` resolves to in `state`, if known.
+  ///
+  /// \return true iff the resolution was found.
+  bool lookup(const ExecutionState &state, ref<Expr> base,
+              ResolutionList &rl);
+
+  /// Records the complete resolution `rl` of `base` in `state`
+  void insert(const ExecutionState &state, ref<Expr> base,
+              const ResolutionList &rl);
+};
+} // namespace klee
+
+#endif /* KLEE_RESOLUTIONCACHE_H */
@@ -27,6 +27,7 @@
 #include "klee/System/Time.h"
 #include "klee/Utilities/Math.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <set>
@@ -211,6 +212,14 @@ void GuidedSearcher::update(
   if (current) {
     localStates.insert(current);
   }
+  // States stepped earlier in the round may be removed without being current,
+  // their target changes must be applied before they are dropped below.
+  for (const auto state : removedStates) {
+    if (std::find(addedStates.begin(), addedStates.end(), state) ==
+        addedStates.end()) {
+      localStates.insert(state);
+    }
+  }
   update(localStates);
   localStates.clear();
 
@@ -4,6 +4,8 @@
 
 #include "ExecutionState.h"
 
+#include "klee/Solver/SolverUtil.h"
+
 namespace klee {
 
 struct SearcherAction {
@@ -14,7 +16,7 @@ protected:
   class ReferenceCounter _refCount;
 
 public:
-  enum class Kind { Forward };
+  enum class Kind { Forward, Resume };
 
   SearcherAction() = default;
   virtual ~SearcherAction() = default;
@@ -38,6 +40,28 @@ struct ForwardAction : public SearcherAction {
   static bool classof(const ForwardAction *) { return true; }
 };
 
+/// Resumes a state which was parked while its branch condition was being
+/// evaluated by a background solver worker.
+struct ResumeAction : public SearcherAction {
+  friend class ref<ResumeAction>;
+
+  ExecutionState *state;
+  ref<Expr> condition;
+  PartialValidity validity;
+  bool success;
+
+  ResumeAction(ExecutionState *_state, ref<Expr> _condition,
+               PartialValidity _validity, bool _success)
+      : state(_state), condition(_condition), validity(_validity),
+        success(_success) {}
+
+  Kind getKind() const { return Kind::Resume; }
+  static bool classof(const SearcherAction *A) {
+    return A->getKind() == Kind::Resume;
+  }
+  static bool classof(const ResumeAction *) { return true; }
+};
+
 } // namespace klee
 
 #endif
@@ -10,6 +10,7 @@
 #include "SpecialFunctionHandler.h"
 
 #include "CodeEvent.h"
+#include "CoreStats.h"
 #include "ExecutionState.h"
 #include "Executor.h"
 #include "Memory.h"
@@ -61,6 +62,12 @@ cl::opt<bool> CheckOutOfMemory("check-out-of-memory", cl::init(false),
                                cl::desc("Enable out-of-memory checking during "
                                         "memory allocation (default=false)"),
                                cl::cat(ExecCat));
+
+cl::opt<bool> BulkMemoryFunctions(
+    "bulk-memory-functions", cl::init(true),
+    cl::desc("Run memcpy, memmove, memset, memcmp and strlen on concrete "
+             "objects without executing their bodies (default=true)"),
+    cl::cat(ExecCat));
 } // namespace
 
 /// \todo Almost all of the demands in this file should be replaced
@@ -238,6 +245,22 @@ void SpecialFunctionHandler::bind() {
       }
     }
   }
+
+  if (!BulkMemoryFunctions)
+    return;
+
+  static const std::pair<const char *, FastPath> fastPathInfo[] = {
+      {"memcpy", &SpecialFunctionHandler::fastMemcpy},
+      {"memmove", &SpecialFunctionHandler::fastMemcpy},
+      {"memset", &SpecialFunctionHandler::fastMemset},
+      {"memcmp", &SpecialFunctionHandler::fastMemcmp},
+      {"strlen", &SpecialFunctionHandler::fastStrlen},
+  };
+  for (const auto &fi : fastPathInfo) {
+    Function *f = executor.kmodule->module->getFunction(fi.first);
+    if (f && !handlers.count(f))
+      fastPaths[f] = fi.second;
+  }
 }
 
 bool SpecialFunctionHandler::handle(ExecutionState &state, Function *f,
@@ -260,6 +283,19 @@ bool SpecialFunctionHandler::handle(ExecutionState &state, Function *f,
   }
 }
 
+bool SpecialFunctionHandler::handleFastPath(
+    ExecutionState &state, Function *f, KInstruction *target,
+    std::vector<ref<Expr>> &arguments) {
+  fast_paths_ty::iterator it = fastPaths.find(f);
+  if (it == fastPaths.end())
+    return false;
+  FastPath fp = it->second;
+  if (!(this->*fp)(state, target, arguments))
+    return false;
+  ++stats::bulkMemoryCalls;
+  return true;
+}
+
 /****/
 
 // reads a concrete string from memory
@@ -314,6 +350,32 @@ SpecialFunctionHandler::readStringAtAddress(ExecutionState &state,
   return buf.str();
 }
 
+bool SpecialFunctionHandler::resolveConcreteRange(ExecutionState &state,
+                                                  ref<Expr> address,
+                                                  uint64_t length,
+                                                  const MemoryObject *&mo,
+                                                  const ObjectState *&os,
+                                                  unsigned &offset) {
+  ref<ConstantPointerExpr> pointer =
+      dyn_cast<ConstantPointerExpr>(executor.makePointer(address));
+  ObjectPair op;
+  if (!pointer || !state.addressSpace.resolveOne(pointer, op))
+    return false;
+  mo = op.first;
+  os = op.second;
+
+  // resolveOne only accepts objects of concrete address and size
+  uint64_t moAddress = cast<ConstantExpr>(mo->getBaseExpr())->getZExtValue();
+  uint64_t moSize = cast<ConstantExpr>(mo->getSizeExpr())->getZExtValue();
+  if (pointer->getConstantBase()->getZExtValue() != moAddress)
+    return false;
+  uint64_t start = pointer->getConstantValue()->getZExtValue() - moAddress;
+  if (start > moSize || length > moSize - start)
+    return false;
+  offset = start;
+  return true;
+}
+
 /****/
 
 void SpecialFunctionHandler::handleAbort(
@@ -978,7 +1040,7 @@ void SpecialFunctionHandler::handleMakeMock(ExecutionState &state,
       case MockStrategyKind::Deterministic:
         std::vector<ref<Expr>> args(kf->getNumArgs());
         for (size_t i = 0; i < kf->getNumArgs(); i++) {
-          args[i] = executor.getArgumentCell(state, kf, i).value;
+          args[i] = executor.getArgumentCell(state, kf, i).value();
         }
         source = SourceBuilder::mockDeterministic(executor.kmodule.get(),
                                                   *kf->function(), args);
@@ -1163,3 +1225,125 @@ void SpecialFunctionHandler::handleCTypeToUpperLoc(ExecutionState &state,
 }
 
 #endif
+
+/* Fast paths */
+
+// Each fast path runs the call on the bytes of the objects it touches when
+// its pointers and sizes are concrete and in bounds, and leaves the call to
+// the body otherwise, which forks or reports the error as the program would.
+
+bool SpecialFunctionHandler::fastMemcpy(ExecutionState &state,
+                                        KInstruction *target,
+                                        std::vector<ref<Expr>> &arguments) {
+  // void *memcpy(void *dest, const void *src, size_t n)
+  if (arguments.size() != 3)
+    return false;
+  ref<ConstantExpr> length = dyn_cast<ConstantExpr>(arguments[2]);
+  if (!length || length->getWidth() > Expr::Int64)
+    return false;
+  uint64_t n = length->getZExtValue();
+
+  const MemoryObject *dstMo, *srcMo;
+  const ObjectState *dstOs, *srcOs;
+  unsigned dstOffset, srcOffset;
+  if (!resolveConcreteRange(state, arguments[0], n, dstMo, dstOs, dstOffset) ||
+      !resolveConcreteRange(state, arguments[1], n, srcMo, srcOs, srcOffset) ||
+      dstOs->readOnly)
+    return false;
+
+  ObjectState *wos = state.addressSpace.getWriteable(dstMo, dstOs);
+  // The source may be the object getWriteable just replaced
+  wos->copyBytes(dstOffset, srcMo == dstMo ? *wos : *srcOs, srcOffset, n);
+  executor.bindLocal(target, state, arguments[0]);
+  return true;
+}
+
+bool SpecialFunctionHandler::fastMemset(ExecutionState &state,
+                                        KInstruction *target,
+                                        std::vector<ref<Expr>> &arguments) {
+  // void *memset(void *s, int c, size_t n)
+  if (arguments.size() != 3 || isa<PointerExpr>(arguments[1]))
+    return false;
+  ref<ConstantExpr> length = dyn_cast<ConstantExpr>(arguments[2]);
+  if (!length || length->getWidth() > Expr::Int64)
+    return false;
+  uint64_t n = length->getZExtValue();
+
+  const MemoryObject *mo;
+  const ObjectState *os;
+  unsigned offset;
+  if (!resolveConcreteRange(state, arguments[0], n, mo, os, offset) ||
+      os->readOnly)
+    return false;
+
+  ObjectState *wos = state.addressSpace.getWriteable(mo, os);
+  wos->fillBytes(offset, ExtractExpr::create(arguments[1], 0, Expr::Int8), n);
+  executor.bindLocal(target, state, arguments[0]);
+  return true;
+}
+
+bool SpecialFunctionHandler::fastMemcmp(ExecutionState &state,
+                                        KInstruction *target,
+                                        std::vector<ref<Expr>> &arguments) {
+  // int memcmp(const void *s1, const void *s2, size_t n)
+  if (arguments.size() != 3)
+    return false;
+  ref<ConstantExpr> length = dyn_cast<ConstantExpr>(arguments[2]);
+  if (!length || length->getWidth() > Expr::Int64)
+    return false;
+  uint64_t n = length->getZExtValue();
+
+  const MemoryObject *mo1, *mo2;
+  const ObjectState *os1, *os2;
+  unsigned offset1, offset2;
+  if (!resolveConcreteRange(state, arguments[0], n, mo1, os1, offset1) ||
+      !resolveConcreteRange(state, arguments[1], n, mo2, os2, offset2))
+    return false;
+
+  int64_t result = 0;
+  for (uint64_t i = 0; i < n && result == 0; ++i) {
+    // A symbolic byte before the first difference makes the result
+    // symbolic, which the body handles by forking
+    ref<ConstantExpr> byte1 = dyn_cast<ConstantExpr>(os1->read8(offset1 + i));
+    ref<ConstantExpr> byte2 = dyn_cast<ConstantExpr>(os2->read8(offset2 + i));
+    if (!byte1 || !byte2)
+      return false;
+    result = (int64_t)byte1->getZExtValue(8) -
+             (int64_t)byte2->getZExtValue(8);
+  }
+
+  Expr::Width width = executor.getWidthForLLVMType(target->inst()->getType());
+  executor.bindLocal(target, state,
+                     ConstantExpr::alloc(APInt(width, result, true)));
+  return true;
+}
+
+bool SpecialFunctionHandler::fastStrlen(ExecutionState &state,
+                                        KInstruction *target,
+                                        std::vector<ref<Expr>> &arguments) {
+  // size_t strlen(const char *s)
+  if (arguments.size() != 1)
+    return false;
+
+  const MemoryObject *mo;
+  const ObjectState *os;
+  unsigned offset;
+  if (!resolveConcreteRange(state, arguments[0], 0, mo, os, offset))
+    return false;
+
+  uint64_t moSize = cast<ConstantExpr>(mo->getSizeExpr())->getZExtValue();
+  for (uint64_t i = offset; i < moSize; ++i) {
+    ref<ConstantExpr> byte = dyn_cast<ConstantExpr>(os->read8(i));
+    if (!byte)
+      return false;
+    if (byte->isZero()) {
+      Expr::Width width =
+          executor.getWidthForLLVMType(target->inst()->getType());
+      executor.bindLocal(target, state,
+                         ConstantExpr::create(i - offset, width));
+      return true;
+    }
+  }
+  // An unterminated string is left to the body, which reads out of bounds
+  return false;
+}
@@ -12,6 +12,7 @@
 
 #include "klee/Config/config.h"
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -26,6 +27,8 @@ class Expr;
 class PointerExpr;
 class ExecutionState;
 struct KInstruction;
+class MemoryObject;
+class ObjectState;
 template <typename T> class ref;
 
 class SpecialFunctionHandler {
@@ -36,7 +39,15 @@ public:
   typedef std::map<const llvm::Function *, std::pair<Handler, bool>>
       handlers_ty;
 
+  /// Runs a call of a function with a body in place of that body, and
+  /// returns false to leave the call to the body.
+  typedef bool (SpecialFunctionHandler::*FastPath)(
+      ExecutionState &state, KInstruction *target,
+      std::vector<ref<Expr>> &arguments);
+  typedef std::map<const llvm::Function *, FastPath> fast_paths_ty;
+
   handlers_ty handlers;
+  fast_paths_ty fastPaths;
   class Executor &executor;
 
   struct HandlerInfo {
@@ -66,11 +77,23 @@ public:
   bool handle(ExecutionState &state, llvm::Function *f, KInstruction *target,
               std::vector<ref<Expr>> &arguments);
 
+  /// Runs a call of a memory function on concrete objects without
+  /// executing its body. Returns true iff the call was handled.
+  bool handleFastPath(ExecutionState &state, llvm::Function *f,
+                      KInstruction *target, std::vector<ref<Expr>> &arguments);
+
   /* Convenience routines */
 
   std::string readStringAtAddress(ExecutionState &state,
                                   ref<PointerExpr> address);
 
+  /// Finds the object holding the `length` bytes at the concrete `address`,
+  /// and the offset of `address` in it. Fails if the address is symbolic or
+  /// the bytes do not all lie in a single object of concrete size.
+  bool resolveConcreteRange(ExecutionState &state, ref<Expr> address,
+                            uint64_t length, const MemoryObject *&mo,
+                            const ObjectState *&os, unsigned &offset);
+
   /* Handlers */
 
 #define HANDLER(name)                                                          \
@@ -156,6 +179,17 @@ public:
   HANDLER(handleCTypeToUpperLoc);
 #endif
 #undef HANDLER
+
+  /* Fast paths */
+
+#define FAST_PATH(name)                                                        \
+  bool name(ExecutionState &state, KInstruction *target,                       \
+            std::vector<ref<Expr>> &arguments)
+  FAST_PATH(fastMemcpy);
+  FAST_PATH(fastMemset);
+  FAST_PATH(fastMemcmp);
+  FAST_PATH(fastStrlen);
+#undef FAST_PATH
 };
 } // namespace klee
 
@@ -0,0 +1,503 @@
+//===-- StateSpiller.cpp --------------------------------------------------===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "StateSpiller.h"
+
+#include "AddressSpace.h"
+#include "ConstructStorage.h"
+#include "CoreStats.h"
+#include "ExecutionState.h"
+#include "Memory.h"
+
+#include "klee/Expr/Expr.h"
+#include "klee/Support/ErrorHandling.h"
+
+#include <unordered_map>
+#include <utility>
+
+using namespace klee;
+
+namespace {
+
+/// Returns true if expressions of this kind carry a rounding mode
+bool hasRoundingMode(Expr::Kind kind) {
+  switch (kind) {
+  case Expr::FPTrunc:
+  case Expr::FPToUI:
+  case Expr::FPToSI:
+  case Expr::UIToFP:
+  case Expr::SIToFP:
+  case Expr::FSqrt:
+  case Expr::FRint:
+  case Expr::FAdd:
+  case Expr::FSub:
+  case Expr::FMul:
+  case Expr::FDiv:
+  case Expr::FRem:
+  case Expr::FMax:
+  case Expr::FMin:
+    return true;
+  default:
+    return false;
+  }
+}
+
+llvm::APFloat::roundingMode getRoundingMode(const Expr &e) {
+  switch (e.getKind()) {
+#define RM_CASE(T)                                                             \
+  case Expr::T:                                                                \
+    return cast<T##Expr>(e).roundingMode;
+    RM_CASE(FPTrunc)
+    RM_CASE(FPToUI)
+    RM_CASE(FPToSI)
+    RM_CASE(UIToFP)
+    RM_CASE(SIToFP)
+    RM_CASE(FSqrt)
+    RM_CASE(FRint)
+    RM_CASE(FAdd)
+    RM_CASE(FSub)
+    RM_CASE(FMul)
+    RM_CASE(FDiv)
+    RM_CASE(FRem)
+    RM_CASE(FMax)
+    RM_CASE(FMin)
+#undef RM_CASE
+  default:
+    assert(0 && "expression has no rounding mode");
+    return llvm::APFloat::rmNearestTiesToEven;
+  }
+}
+
+/// Tags of the nodes of a record. Expressions are tagged with their kind.
+enum : uint64_t { UpdateNodeTag = 0, FirstExprTag = 1 };
+
+/// Tags of registers
+enum : uint64_t { NullCell = 0, InlineCell = 1, ExprCell = 2 };
+
+} // namespace
+
+/// Encodes a record. Numbers are written as LEB128 varints. Nodes of the
+/// expression DAG go into `nodes` the first time they are referenced, the
+/// rest of the record into `payload`.
+class StateSpiller::Writer {
+  StateSpiller &spiller;
+  std::unordered_map<const void *, uint64_t> ids;
+
+  struct Node {
+    const Expr *expr;
+    const UpdateNode *update;
+    const void *key() const {
+      return expr ? static_cast<const void *>(expr) : update;
+    }
+  };
+
+  void kids(Node node, std::vector<Node> &result) const {
+    if (const Expr *e = node.expr) {
+      for (unsigned i = 0; i < e->getNumKids(); ++i)
+        result.push_back({e->getKid(i).get(), nullptr});
+      if (auto re = dyn_cast<ReadExpr>(e))
+        result.push_back({nullptr, re->updates.head.get()});
+    } else {
+      const UpdateNode *un = node.update;
+      result.push_back({nullptr, un->next.get()});
+      result.push_back({un->index.get(), nullptr});
+      result.push_back({un->value.get(), nullptr});
+    }
+  }
+
+  uint64_t id(const void *key) const {
+    return key ? ids.at(key) : 0;
+  }
+
+  void emit(Node node) {
+    if (const UpdateNode *un = node.update) {
+      encode(nodes, UpdateNodeTag);
+      encode(nodes, id(un->next.get()));
+      encode(nodes, id(un->index.get()));
+      encode(nodes, id(un->value.get()));
+      return;
+    }
+
+    const Expr *e = node.expr;
+    encode(nodes, FirstExprTag + e->getKind());
+    encode(nodes, e->getWidth());
+    if (auto ce = dyn_cast<ConstantExpr>(e)) {
+      const llvm::APInt &value = ce->getAPValue();
+      encode(nodes, ce->isFloat());
+      for (unsigned i = 0; i < value.getNumWords(); ++i)
+        encode(nodes, value.getRawData()[i]);
+      return;
+    }
+    if (auto ee = dyn_cast<ExtractExpr>(e))
+      encode(nodes, ee->offset);
+    if (auto re = dyn_cast<ReadExpr>(e)) {
+      encode(nodes, spiller.getArrayID(re->updates.root));
+      encode(nodes, id(re->updates.head.get()));
+    }
+    if (hasRoundingMode(e->getKind()))
+      encode(nodes, static_cast<uint64_t>(getRoundingMode(*e)));
+    encode(nodes, e->getNumKids());
+    for (unsigned i = 0; i < e->getNumKids(); ++i)
+      encode(nodes, id(e->getKid(i).get()));
+  }
+
+  /// Writes `root` and all nodes below it which are not written yet
+  uint64_t writeNode(Node root) {
+    if (!root.key())
+      return 0;
+    std::vector<std::pair<Node, bool>> stack{{root, false}};
+    std::vector<Node> pending;
+    while (!stack.empty()) {
+      auto [node, expanded] = stack.back();
+      if (ids.count(node.key())) {
+        stack.pop_back();
+        continue;
+      }
+      if (!expanded) {
+        stack.back().second = true;
+        pending.clear();
+        kids(node, pending);
+        for (Node kid : pending) {
+          if (kid.key() && !ids.count(kid.key()))
+            stack.push_back({kid, false});
+        }
+        continue;
+      }
+      stack.pop_back();
+      emit(node);
+      ids.emplace(node.key(), ++count);
+    }
+    return ids.at(root.key());
+  }
+
+public:
+  std::string nodes;
+  std::string payload;
+  uint64_t count = 0;
+
+  explicit Writer(StateSpiller &spiller) : spiller(spiller) {}
+
+  static void encode(std::string &out, uint64_t value) {
+    do {
+      uint8_t byte = value & 0x7f;
+      value >>= 7;
+      out.push_back(static_cast<char>(value ? byte | 0x80 : byte));
+    } while (value);
+  }
+
+  void write(uint64_t value) { encode(payload, value); }
+  void write(const ref<Expr> &e) { write(writeNode({e.get(), nullptr})); }
+  void write(const ref<UpdateNode> &un) {
+    write(writeNode({nullptr, un.get()}));
+  }
+};
+
+/// Decodes a record written by Writer
+class StateSpiller::Reader {
+  const StateSpiller &spiller;
+  const std::string &bytes;
+  size_t position = 0;
+  /// Nodes by position, starting from 1
+  std::vector<ref<Expr>> exprs{nullptr};
+  std::vector<ref<UpdateNode>> updates{nullptr};
+
+  ref<Expr> readNode(Expr::Kind kind) {
+    Expr::Width width = read();
+    if (kind == Expr::Constant) {
+      bool isFloat = read();
+      std::vector<uint64_t> words((width + 63) / 64);
+      for (auto &word : words)
+        word = read();
+      llvm::APInt value(width, words);
+      if (isFloat)
+        return ConstantExpr::alloc(
+            llvm::APFloat(ConstantExpr::widthToFloatSemantics(width), value));
+      return ConstantExpr::alloc(value);
+    }
+
+    unsigned offset = kind == Expr::Extract ? read() : 0;
+    UpdateList list;
+    if (kind == Expr::Read) {
+      const Array *root = spiller.arrays[read()];
+      list = UpdateList(root, update(read()));
+    }
+    llvm::APFloat::roundingMode rm = llvm::APFloat::rmNearestTiesToEven;
+    if (hasRoundingMode(kind))
+      rm = static_cast<llvm::APFloat::roundingMode>(read());
+
+    std::vector<ref<Expr>> kids(read());
+    for (auto &kid : kids)
+      kid = expr(read());
+
+    switch (kind) {
+    case Expr::Read:
+      return ReadExpr::alloc(list, kids[0]);
+    case Expr::Extract:
+      return ExtractExpr::create(kids[0], offset, width);
+    case Expr::FPExt:
+      return FPExtExpr::create(kids[0], width);
+    case Expr::Pointer:
+      return PointerExpr::create(kids[0], kids[1]);
+    case Expr::ConstantPointer:
+      return ConstantPointerExpr::create(cast<ConstantExpr>(kids[0]),
+                                         cast<ConstantExpr>(kids[1]));
+    default:
+      break;
+    }
+
+    std::vector<Expr::CreateArg> args(kids.begin(), kids.end());
+    if (kind >= Expr::CastKindFirst && kind <= Expr::CastKindLast)
+      args.emplace_back(width);
+    if (hasRoundingMode(kind))
+      args.emplace_back(rm);
+    return Expr::createFromKind(kind, args);
+  }
+
+public:
+  Reader(const StateSpiller &spiller, const std::string &bytes)
+      : spiller(spiller), bytes(bytes) {}
+
+  uint64_t read() {
+    uint64_t value = 0;
+    for (unsigned shift = 0;; shift += 7) {
+      assert(position < bytes.size() && "truncated spill record");
+      uint8_t byte = static_cast<uint8_t>(bytes[position++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return value;
+    }
+  }
+
+  void readNodes(uint64_t count) {
+    exprs.resize(count + 1);
+    updates.resize(count + 1);
+    for (uint64_t id = 1; id <= count; ++id) {
+      uint64_t tag = read();
+      if (tag == UpdateNodeTag) {
+        ref<UpdateNode> next = update(read());
+        ref<Expr> index = expr(read());
+        ref<Expr> value = expr(read());
+        updates[id] = new UpdateNode(next, index, value);
+      } else {
+        exprs[id] = readNode(static_cast<Expr::Kind>(tag - FirstExprTag));
+      }
+    }
+  }
+
+  ref<Expr> expr(uint64_t id) const { return exprs[id]; }
+  ref<UpdateNode> update(uint64_t id) const { return updates[id]; }
+  ref<Expr> readExpr() { return expr(read()); }
+};
+
+/***/
+
+StateSpiller::StateSpiller(const std::string &path)
+    : path(path), file(path, std::ios::in | std::ios::out | std::ios::trunc |
+                                 std::ios::binary) {
+  if (!file)
+    klee_error("unable to open spill file %s", path.c_str());
+}
+
+StateSpiller::~StateSpiller() = default;
+
+void StateSpiller::addBaseline(const ExecutionState &state) {
+  for (const auto &binding : state.addressSpace.objects)
+    baseline.insert(binding.second.get());
+}
+
+uint64_t StateSpiller::getArrayID(const Array *array) {
+  auto it = arrayIDs.find(array);
+  if (it != arrayIDs.end())
+    return it->second;
+  arrays.push_back(array);
+  return arrayIDs[array] = arrays.size() - 1;
+}
+
+void StateSpiller::write(Writer &out, const ObjectStage &stage) {
+  out.write(stage.size);
+  out.write(stage.safeRead);
+  out.write(stage.width);
+  out.write(stage.updates.root ? getArrayID(stage.updates.root) + 1 : 0);
+  out.write(stage.updates.head);
+
+  out.write(stage.knownSymbolics->defaultV());
+  auto known = stage.knownSymbolics->calculateOrderedStorage();
+  out.write(known.size());
+  for (const auto &byte : known) {
+    out.write(byte.first);
+    out.write(byte.second);
+  }
+
+  assert(!stage.unflushedMask->defaultV() && "unexpected unflushed default");
+  auto unflushed = stage.unflushedMask->calculateOrderedStorage();
+  out.write(unflushed.size());
+  for (const auto &byte : unflushed)
+    out.write(byte.first);
+}
+
+void StateSpiller::write(Writer &out, const ObjectState &os) {
+  out.write(os.size);
+  out.write(os.readOnly);
+  out.write(os.wasWritten);
+  out.write(os.lastUpdate);
+  write(out, os.valueOS);
+  write(out, os.baseOS);
+}
+
+ObjectStage StateSpiller::readStage(Reader &in) {
+  ref<Expr> size = in.readExpr();
+  bool safeRead = in.read();
+  Expr::Width width = in.read();
+  uint64_t root = in.read();
+  ref<UpdateNode> head = in.update(in.read());
+  ref<Expr> defaultValue = in.readExpr();
+
+  ObjectStage stage(size, defaultValue, safeRead, width);
+  stage.updates = UpdateList(root ? arrays[root - 1] : nullptr, head);
+  for (uint64_t i = 0, n = in.read(); i < n; ++i) {
+    uint64_t offset = in.read();
+    stage.knownSymbolics->store(offset, in.readExpr());
+  }
+  for (uint64_t i = 0, n = in.read(); i < n; ++i)
+    stage.unflushedMask->store(in.read(), true);
+  return stage;
+}
+
+ObjectState *StateSpiller::readObject(Reader &in, const MemoryObject *mo) {
+  ref<Expr> size = in.readExpr();
+  bool readOnly = in.read();
+  bool wasWritten = in.read();
+  ref<UpdateNode> lastUpdate = in.update(in.read());
+  ObjectStage valueOS = readStage(in);
+  ObjectStage baseOS = readStage(in);
+
+  auto os = new ObjectState(mo, size, std::move(valueOS), std::move(baseOS));
+  os->readOnly = readOnly;
+  os->wasWritten = wasWritten;
+  os->lastUpdate = lastUpdate;
+  return os;
+}
+
+bool StateSpiller::spill(ExecutionState &state) {
+  assert(!isSpilled(state) && "state is already spilled");
+  Writer out(*this);
+  Record record;
+
+  std::vector<std::pair<const MemoryObject *, const ObjectState *>> written;
+  for (const auto &binding : state.addressSpace.objects) {
+    if (!baseline.count(binding.second.get()))
+      written.emplace_back(binding.first, binding.second.get());
+  }
+  out.write(written.size());
+  for (const auto &object : written) {
+    record.objects.push_back(object.first);
+    write(out, *object.second);
+  }
+
+  auto &frames = state.stack.valueStack();
+  out.write(frames.size());
+  for (const auto &frame : frames) {
+    out.write(frame.locals.size());
+    for (unsigned reg = 0; reg < frame.locals.size(); ++reg) {
+      const Cell &cell = frame.locals.at(reg);
+      if (cell.isNull()) {
+        out.write(NullCell);
+      } else if (cell.isConstant()) {
+        out.write(InlineCell);
+        out.write(cell.getWidth());
+        out.write(cell.getZExtValue());
+      } else {
+        out.write(ExprCell);
+        out.write(cell.value());
+      }
+    }
+  }
+
+  std::string header;
+  Writer::encode(header, out.count);
+  record.offset = end;
+  record.length = header.size() + out.nodes.size() + out.payload.size();
+  file.seekp(end);
+  file.write(header.data(), header.size());
+  file.write(out.nodes.data(), out.nodes.size());
+  file.write(out.payload.data(), out.payload.size());
+  file.flush();
+  if (!file) {
+    klee_warning("unable to write to spill file %s", path.c_str());
+    file.clear();
+    return false;
+  }
+  end += record.length;
+
+  for (const auto &object : written)
+    state.addressSpace.unbindObject(object.first);
+  for (auto &frame : frames)
+    frame.locals.clear();
+
+  records.emplace(&state, std::move(record));
+  ++stats::spilledStates;
+  return true;
+}
+
+void StateSpiller::reload(ExecutionState &state) {
+  auto it = records.find(&state);
+  assert(it != records.end() && "state is not spilled");
+  Record &record = it->second;
+
+  std::string bytes(record.length, '\0');
+  file.seekg(record.offset);
+  file.read(&bytes[0], record.length);
+  if (!file)
+    klee_error("unable to read state %u from spill file %s", state.id,
+               path.c_str());
+
+  Reader in(*this, bytes);
+  in.readNodes(in.read());
+
+  uint64_t objects = in.read();
+  assert(objects == record.objects.size());
+  for (uint64_t i = 0; i < objects; ++i) {
+    const MemoryObject *mo = record.objects[i].get();
+    state.addressSpace.bindObject(mo, readObject(in, mo));
+  }
+
+  auto &frames = state.stack.valueStack();
+  uint64_t frameCount = in.read();
+  (void)frameCount;
+  assert(frameCount == frames.size() && "stack changed while spilled");
+  for (auto &frame : frames) {
+    uint64_t locals = in.read();
+    (void)locals;
+    assert(locals == frame.locals.size());
+    for (unsigned reg = 0; reg < frame.locals.size(); ++reg) {
+      switch (in.read()) {
+      case InlineCell: {
+        Expr::Width width = in.read();
+        frame.locals.set(reg, Cell(in.read(), width));
+        break;
+      }
+      case ExprCell:
+        frame.locals.set(reg, Cell(in.readExpr()));
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  records.erase(it);
+  ++stats::reloadedStates;
+}
+
+void StateSpiller::update(ref<ObjectManager::Event> e) {
+  if (auto statesEvent = dyn_cast<ObjectManager::States>(e)) {
+    for (auto state : statesEvent->removed)
+      records.erase(state);
+  }
+}
@@ -0,0 +1,99 @@
+//===-- StateSpiller.h ------------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef KLEE_STATESPILLER_H
+#define KLEE_STATESPILLER_H
+
+#include "ObjectManager.h"
+
+#include "klee/ADT/Ref.h"
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace klee {
+class Array;
+class ExecutionState;
+class MemoryObject;
+class ObjectStage;
+class ObjectState;
+
+/// Moves the memory of cold states to a spill file and back. A spilled state
+/// keeps its stack frames, path constraints and process tree node, so
+/// searchers can still rank it, but its register values and the objects
+/// written since the initial state are only kept in the file until the state
+/// is reloaded. Objects still bound as in the initial state are shared by
+/// most states and stay in memory.
+///
+/// The expressions of a record are written as a DAG: every expression and
+/// update node is written once, after its kids, and is referred to by its
+/// position in the record.
+class StateSpiller : public Subscriber {
+  struct Record {
+    std::streamoff offset;
+    size_t length;
+    /// Memory objects whose contents are in the record, kept alive while
+    /// they are unbound
+    std::vector<ref<const MemoryObject>> objects;
+  };
+
+  std::string path;
+  std::fstream file;
+  std::streamoff end = 0;
+  std::unordered_map<const ExecutionState *, Record> records;
+
+  /// Objects bound in the initial states, which are never spilled. Once an
+  /// object is freed its address may be reused, which only means that the new
+  /// object stays in memory as well.
+  std::unordered_set<const ObjectState *> baseline;
+
+  /// Arrays live as long as the process, so records refer to them by index
+  std::vector<const Array *> arrays;
+  std::unordered_map<const Array *, uint64_t> arrayIDs;
+
+  class Writer;
+  class Reader;
+
+  uint64_t getArrayID(const Array *array);
+
+  void write(Writer &out, const ObjectStage &stage);
+  void write(Writer &out, const ObjectState &os);
+  ObjectStage readStage(Reader &in);
+  ObjectState *readObject(Reader &in, const MemoryObject *mo);
+
+public:
+  explicit StateSpiller(const std::string &path);
+  ~StateSpiller() override;
+
+  bool isSpilled(const ExecutionState &state) const {
+    return records.count(&state);
+  }
+
+  /// Keeps the objects bound in `state` in memory when states are spilled
+  void addBaseline(const ExecutionState &state);
+
+  /// Number of states currently spilled
+  size_t size() const { return records.size(); }
+
+  /// Writes the registers and the written objects of `state` to the spill file
+  /// and drops them from memory. Returns false, leaving the state unchanged,
+  /// if the file cannot be written.
+  bool spill(ExecutionState &state);
+
+  /// Restores a spilled state as it was before spill() was called.
+  void reload(ExecutionState &state);
+
+  void update(ref<ObjectManager::Event> e) override;
+};
+} // namespace klee
+
+#endif /* KLEE_STATESPILLER_H */
@@ -500,6 +500,8 @@ void StatsTracker::writeStatsHeader() {
          << "UserTime REAL,"
          << "NumStates INTEGER,"
          << "MallocUsage INTEGER,"
+         << "StatesMemoryUsage INTEGER,"
+         << "MaxStateMemoryUsage INTEGER,"
          << "Queries INTEGER,"
          << "SolverQueries INTEGER,"
          << "NumQueryConstructs INTEGER,"
@@ -549,6 +551,8 @@ void StatsTracker::writeStatsHeader() {
          << "UserTime,"
          << "NumStates,"
          << "MallocUsage,"
+         << "StatesMemoryUsage,"
+         << "MaxStateMemoryUsage,"
          << "Queries,"
          << "SolverQueries,"
          << "NumQueryConstructs,"
@@ -599,6 +603,8 @@ void StatsTracker::writeStatsHeader() {
          << "?,"
          << "?,"
          << "?,"
+         << "?,"
+         << "?,"
          << "?," BRANCH_TYPES TERMINATION_CLASSES << "? " << ')';
 
   if (sqlite3_prepare_v2(statsFile, insert.str().c_str(), -1, &insertStmt,
@@ -631,6 +637,11 @@ void StatsTracker::writeStatsLine() {
       insertStmt, arg++,
       util::GetTotalMallocUsage() +
           (executor.memory ? executor.memory->getUsedDeterministicSize() : 0));
+  sqlite3_bind_int64(insertStmt, arg++, executor.accountStateMemory());
+  std::uint64_t maxStateMemoryUsage = 0;
+  for (const auto state : executor.objectManager->getStates())
+    maxStateMemoryUsage = std::max(maxStateMemoryUsage, state->memoryUsage);
+  sqlite3_bind_int64(insertStmt, arg++, maxStateMemoryUsage);
   sqlite3_bind_int64(insertStmt, arg++, stats::queries);
   sqlite3_bind_int64(insertStmt, arg++, stats::solverQueries);
   sqlite3_bind_int64(insertStmt, arg++, stats::queryConstructs);
@@ -256,9 +256,17 @@ void TargetManager::update(ExecutionState *current,
     pair.second.clear();
   }
 
-  for (auto state : changedStates) {
+  // States changed while being stepped are collected with their own event,
+  // which comes later if several states are stepped in one round.
+  for (auto it = changedStates.begin(); it != changedStates.end();) {
+    auto state = *it;
+    if (!localStates.count(state)) {
+      ++it;
+      continue;
+    }
     collect(*state);
     state->stepTargetsAndHistory();
+    it = changedStates.erase(it);
   }
 
   for (const auto state : removedStates) {
@@ -266,7 +274,6 @@ void TargetManager::update(ExecutionState *current,
     distances.erase(state);
   }
 
-  changedStates.clear();
   localStates.clear();
 }
 
@@ -277,6 +277,7 @@ void ConstraintSet::checkCopyOnWriteOwner() {
         IndependentConstraintSetUnion(*_independentElements));
     _concretization =
         std::make_shared<Assignment>(Assignment(*_concretization));
+    copyOnWriteOwner = cowKey;
   }
 }
 
@@ -361,6 +362,18 @@ void ConstraintSet::changeCS(constraints_ty &cs) {
                                     *_concretization));
 }
 
+void ConstraintSet::replaceConstraints(const constraints_ty &removed,
+                                       const constraints_ty &added) {
+  checkCopyOnWriteOwner();
+  for (const auto &constraint : removed)
+    _constraints.erase(constraint);
+  _independentElements->removeExprs(removed);
+  for (const auto &constraint : added) {
+    _constraints.insert(constraint);
+    _independentElements->addExpr(constraint);
+  }
+}
+
 const constraints_ty &ConstraintSet::cs() const { return _constraints; }
 
 const symcretes_ty &ConstraintSet::symcretes() const { return _symcretes; }
@@ -395,9 +408,30 @@ PathConstraints::orderedCS() const {
 
 void PathConstraints::advancePath(KInstruction *ki) { _path.advance(ki); }
 
+/// Collects into `component` the constraints of `cs` which share arrays with
+/// `e`. Only they may rewrite `e` or be rewritten by it.
+///
+/// \return false iff some of them depend on symcretes, whose concretization
+/// may have been applied to the independent sets.
+static bool collectDependentConstraints(const ConstraintSet &cs, ref<Expr> e,
+                                        constraints_ty &component) {
+  std::vector<ref<const IndependentConstraintSet>> factors;
+  cs.getAllDependentConstraintsSets(e, factors);
+  for (const auto &factor : factors) {
+    if (!factor->symcretes.empty())
+      return false;
+    for (const auto &constraint : factor->exprs)
+      component.insert(constraint);
+  }
+  return true;
+}
+
 ExprHashSet PathConstraints::addConstraint(ref<Expr> e,
                                            Path::PathIndex currIndex) {
-  auto expr = Simplificator::simplifyExpr(constraints, e);
+  constraints_ty dependent;
+  auto expr = collectDependentConstraints(constraints, e, dependent)
+                  ? Simplificator::simplifyExpr(dependent, e)
+                  : Simplificator::simplifyExpr(constraints, e);
   if (auto ce [[maybe_unused]] = dyn_cast<ConstantExpr>(expr.simplified)) {
     assert(ce->isTrue() && "Attempt to add invalid constraint");
     return {};
@@ -420,7 +454,22 @@ ExprHashSet PathConstraints::addConstraint(ref<Expr> e,
     }
   }
 
-  if (RewriteEqualities != RewriteEqualitiesPolicy::None) {
+  if (RewriteEqualities == RewriteEqualitiesPolicy::None)
+    return added;
+
+  // The other constraints were rewritten when they were added and the new
+  // ones cannot rewrite them, so only the independent sets of the new ones
+  // are simplified again
+  constraints_ty component;
+  bool incremental = true;
+  for (const auto &expr : added) {
+    if (!collectDependentConstraints(constraints, expr, component)) {
+      incremental = false;
+      break;
+    }
+  }
+
+  if (!incremental) {
     auto simplified =
         Simplificator::simplify(constraints.cs(), RewriteEqualities);
     if (simplified.wasSimplified) {
@@ -429,11 +478,48 @@ ExprHashSet PathConstraints::addConstraint(ref<Expr> e,
       _simplificationMap = Simplificator::composeExprDependencies(
           _simplificationMap, simplified.dependency);
     }
+  } else if (!component.empty()) {
+    auto simplified = Simplificator::simplify(component, RewriteEqualities);
+    if (simplified.wasSimplified) {
+      constraints.replaceConstraints(component, simplified.simplified);
+
+      auto dependency = Simplificator::composeExprDependencies(
+          _simplificationMap, simplified.dependency);
+      for (const auto &constraint : component)
+        _simplificationMap.erase(constraint);
+      for (const auto &constraint : dependency)
+        _simplificationMap[constraint.first] = constraint.second;
+    }
   }
 
   return added;
 }
 
+PathConstraints PathConstraints::join(const PathConstraints &l,
+                                      const PathConstraints &r,
+                                      ref<Expr> &inL) {
+  PathConstraints result;
+  result._path = l._path;
+  inL = Expr::createTrue();
+  ref<Expr> inR = Expr::createTrue();
+  for (const auto &constraint : l.cs().cs()) {
+    if (r.cs().cs().count(constraint)) {
+      result.addConstraint(constraint);
+    } else {
+      inL = AndExpr::create(inL, constraint);
+    }
+  }
+  for (const auto &constraint : r.cs().cs()) {
+    if (!l.cs().cs().count(constraint)) {
+      inR = AndExpr::create(inR, constraint);
+    }
+  }
+  // States forked on a condition and its negation need no disjunction
+  if (inR != Expr::createIsZero(inL) && inL != Expr::createIsZero(inR))
+    result.addConstraint(OrExpr::create(inL, inR));
+  return result;
+}
+
 ExprHashSet PathConstraints::addConstraint(ref<Expr> e) {
   return addConstraint(e, _path.getCurrentIndex());
 }
@@ -135,7 +135,11 @@ void Expr::splitAnds(ref<Expr> e, std::vector<ref<Expr>> &exprs) {
 }
 
 int Expr::compare(const Expr &b) const {
+#ifdef KLEE_THREAD_SAFE_EXPR
+  static thread_local ExprEquivSet equivs;
+#else
   static ExprEquivSet equivs;
+#endif
   int r = compare(b, equivs);
   equivs.clear();
   return r;
@@ -571,37 +575,93 @@ Expr::ExprCacheSet Expr::cachedExpressions;
 Expr::ConstantExprCacheSet Expr::cachedConstantExpressions;
 
 Expr::~Expr() {
+#ifdef KLEE_THREAD_SAFE_EXPR
+  if (isConcurrentRefs())
+    __atomic_fetch_sub(&Expr::count, 1, __ATOMIC_RELAXED);
+  else
+    Expr::count--;
+#else
   Expr::count--;
+#endif
+  auto &shard = cachedExpressions.shardFor(hashValue);
+  std::lock_guard<CacheMutex> lock(shard.mutex);
   if (isCached) {
     toBeCleared = true;
-    cachedExpressions.cache.erase(this);
+    shard.cache.erase(this);
     isCached = false;
   }
 }
 
 ConstantExpr::~ConstantExpr() {
-  if (isCached) {
-    toBeCleared = true;
-    if (mIsFloat) {
-      cachedExpressions.cache.erase(this);
-    } else {
-      cachedConstantExpressions.cache.erase(value);
+  if (mIsFloat) {
+    auto &shard = cachedExpressions.shardFor(hashValue);
+    std::lock_guard<CacheMutex> lock(shard.mutex);
+    if (isCached) {
+      toBeCleared = true;
+      shard.cache.erase(this);
+      isCached = false;
+    }
+  } else {
+    auto &shard = cachedConstantExpressions.shardFor(value);
+    std::lock_guard<CacheMutex> lock(shard.mutex);
+    if (isCached) {
+      toBeCleared = true;
+      shard.cache.erase(value);
+      isCached = false;
     }
-    isCached = false;
   }
 }
 
 Expr::ConstantExprCacheSet::~ConstantExprCacheSet() {
-  while (cache.size() != 0) {
-    auto tmp = *cache.begin();
-    tmp.second->isCached = false;
-    cache.erase(cache.begin());
+  for (auto &shard : shards) {
+    while (shard.cache.size() != 0) {
+      auto tmp = *shard.cache.begin();
+      tmp.second->isCached = false;
+      shard.cache.erase(shard.cache.begin());
+    }
   }
 }
 
+#ifdef KLEE_THREAD_SAFE_EXPR
+ref<Expr> Expr::createCachedExpr(ref<Expr> e) {
+  // Candidates which turn out to differ from `e` are released only after the
+  // shard lock is dropped, as releasing them may destroy them.
+  std::vector<ref<Expr>> mismatches;
+  auto &shard = cachedExpressions.shardFor(e->hash());
+  std::lock_guard<CacheMutex> lock(shard.mutex);
+  auto &cache = shard.cache;
+  size_t bucket = cache.bucket(e.get());
+  for (auto it = cache.begin(bucket), ie = cache.end(bucket); it != ie; ++it) {
+    Expr *cached = *it;
+    if (cached->hash() != e->hash())
+      continue;
+    if (!isConcurrentRefs()) {
+      if (e->equals(*cached))
+        return cached;
+      continue;
+    }
+    // Expressions whose last reference is being dropped by another thread
+    // are partially destroyed and must not be inspected.
+    if (!cached->_refCount.tryAcquire())
+      continue;
+    ref<Expr> candidate(cached);
+    cached->_refCount.releaseAcquired();
+    if (e->equals(*candidate)) {
+      // Cache hit
+      return candidate;
+    }
+    mismatches.push_back(candidate);
+  }
+  // Cache miss
+  cache.insert(e.get());
+  e->isCached = true;
+  return e;
+}
+#else
 ref<Expr> Expr::createCachedExpr(ref<Expr> e) {
   std::pair<CacheType::const_iterator, bool> success;
-  success = cachedExpressions.cache.insert(e.get());
+  auto &shard = cachedExpressions.shardFor(e->hash());
+  success = shard.cache.insert(e.get());
   if (success.second) {
     // Cache miss
     e->isCached = true;
@@ -610,6 +670,7 @@ ref<Expr> Expr::createCachedExpr(ref<Expr> e) {
   // Cache hit
   return (ref<Expr>)*(success.first);
 }
+#endif
 /***/
 
 ref<Expr> ConstantExpr::fromMemory(void *address, Width width) {
@@ -1542,6 +1603,13 @@ ref<Expr> ReadExpr::create(const UpdateList &ul, ref<Expr> index, bool safe) {
   // array element has been updated
   auto un = ul.head.get();
   bool updateListHasSymbolicWrites = false;
+  // Long update lists know where the scan for a concrete index stops
+  if (un && un->isIndexed()) {
+    if (ConstantExpr *CE = dyn_cast<ConstantExpr>(index)) {
+      if (CE->getWidth() <= 64)
+        un = un->findConcrete(CE->getZExtValue());
+    }
+  }
   for (; un; un = un->next.get()) {
     ref<Expr> cond = EqExpr::create(index, un->index);
     if (ConstantExpr *CE = dyn_cast<ConstantExpr>(cond)) {
@@ -146,6 +146,31 @@ void IndependentConstraintSetUnion::addSymcrete(ref<Symcrete> s) {
   constraintQueue.push_back(new ExprOrSymcrete::right(s));
 }
 
+void IndependentConstraintSetUnion::removeExprs(const constraints_ty &exprs) {
+  flushConstraints();
+  internal_storage_ty groups;
+  for (ref<Expr> e : exprs) {
+    ref<ExprOrSymcrete> value = new ExprOrSymcrete::left(e);
+    if (internalStorage.count(value))
+      groups.insert(find(value));
+  }
+
+  for (const auto &root : groups) {
+    ref<const IndependentConstraintSet> group = disjointSets.at(root);
+    assert(group->symcretes.empty() && "removing a group with symcretes");
+    for (ref<Expr> e : group->exprs) {
+      ref<ExprOrSymcrete> value = new ExprOrSymcrete::left(e);
+      parent.erase(value);
+      rank.erase(value);
+      internalStorage.erase(value);
+      if (!exprs.count(e))
+        addExpr(e);
+    }
+    roots.erase(root);
+    disjointSets.erase(root);
+  }
+}
+
 IndependentConstraintSetUnion
 IndependentConstraintSetUnion::getConcretizedVersion() {
   flushConcretization();
@@ -9,9 +9,46 @@
 
 #include "klee/Expr/Expr.h"
 
+#include "klee/Expr/SourceBuilder.h"
+#include "klee/Support/OptionCategories.h"
+
+#include "llvm/Support/CommandLine.h"
+
+#include <immer/map.hpp>
+
 #include <cassert>
+#include <unordered_set>
 
 using namespace klee;
+using namespace llvm;
+
+namespace {
+cl::opt<unsigned> UpdateIndexThreshold(
+    "update-index-threshold", cl::init(64),
+    cl::desc("Index the updates at concrete indices of update lists with at "
+             "least this many updates, so that reads at concrete indices do "
+             "not scan them (default=64, 0=off)"),
+    cl::cat(klee::ExprCat));
+
+cl::opt<unsigned> UpdateCompactionThreshold(
+    "update-compaction-threshold", cl::init(256),
+    cl::desc("Compact update lists once they have at least this many "
+             "updates and twice as many as after their last compaction, "
+             "dropping overwritten updates and folding the constant updates "
+             "at their bottom into their constant array (default=256, 0=off)"),
+    cl::cat(klee::ExprCat));
+} // namespace
+
+namespace klee {
+class UpdateIndex {
+public:
+  /// latest update of each concrete index
+  immer::map<uint64_t, UpdateNode *> latest;
+
+  /// first update at a symbolic index below the indexed updates
+  UpdateNode *barrier = nullptr;
+};
+} // namespace klee
 
 ///
 
@@ -27,6 +64,46 @@ UpdateNode::UpdateNode(const ref<UpdateNode> &_next, const ref<Expr> &_index,
   computeHash();
   computeHeight();
   size = next ? next->size + 1 : 1;
+  compactedSize = next ? next->compactedSize : 0;
+  if (UpdateIndexThreshold && size >= UpdateIndexThreshold)
+    buildIndex();
+}
+
+void UpdateNode::buildIndex() {
+  // Scans for a concrete index stop at an update at a symbolic index
+  ConstantExpr *CE = dyn_cast<ConstantExpr>(index);
+  if (!CE || CE->getWidth() > 64)
+    return;
+
+  auto result = std::make_shared<UpdateIndex>();
+  if (next && next->concreteIndex) {
+    *result = *next->concreteIndex;
+  } else {
+    // The sequence just got long enough, or starts over after an update at
+    // a symbolic index
+    std::vector<UpdateNode *> run;
+    UpdateNode *un = next.get();
+    for (; un; un = un->next.get()) {
+      ConstantExpr *unIndex = dyn_cast<ConstantExpr>(un->index);
+      if (!unIndex || unIndex->getWidth() > 64)
+        break;
+      run.push_back(un);
+    }
+    result->barrier = un;
+    for (auto it = run.rbegin(); it != run.rend(); ++it) {
+      uint64_t key = cast<ConstantExpr>((*it)->index)->getZExtValue();
+      result->latest = std::move(result->latest).set(key, *it);
+    }
+  }
+  result->latest = std::move(result->latest).set(CE->getZExtValue(), this);
+  concreteIndex = std::move(result);
+}
+
+UpdateNode *UpdateNode::findConcrete(uint64_t index) const {
+  assert(concreteIndex && "update sequence is not indexed");
+  if (UpdateNode *const *un = concreteIndex->latest.find(index))
+    return *un;
+  return concreteIndex->barrier;
 }
 
 extern "C" void vc_DeleteExpr(void *);
@@ -67,6 +144,66 @@ void UpdateList::extend(const ref<Expr> &index, const ref<Expr> &value) {
   }
 
   head = new UpdateNode(head, index, value);
+
+  if (UpdateCompactionThreshold && head->size >= UpdateCompactionThreshold &&
+      head->size >= 2 * head->compactedSize)
+    compact();
+}
+
+void UpdateList::compact() {
+  // An update is dead if a later one writes the same concrete index, as a
+  // read of that index, concrete or not, finds the later one first
+  std::vector<const UpdateNode *> kept;
+  std::unordered_set<uint64_t> written;
+  bool dropped = false;
+  for (const UpdateNode *un = head.get(); un; un = un->next.get()) {
+    ConstantExpr *CE = dyn_cast<ConstantExpr>(un->index);
+    if (CE && CE->getWidth() <= 64 &&
+        !written.insert(CE->getZExtValue()).second) {
+      dropped = true;
+      continue;
+    }
+    kept.push_back(un);
+  }
+
+  const Array *newRoot = root;
+  ConstantSource *constantSource =
+      root ? dyn_cast<ConstantSource>(root->source) : nullptr;
+  ConstantExpr *rootSize = root ? dyn_cast<ConstantExpr>(root->size) : nullptr;
+  if (constantSource && rootSize) {
+    size_t bottom = kept.size();
+    for (; bottom > 0; --bottom) {
+      const UpdateNode *un = kept[bottom - 1];
+      ConstantExpr *index = dyn_cast<ConstantExpr>(un->index);
+      if (!index || !isa<ConstantExpr>(un->value) || index->getWidth() > 64 ||
+          index->getZExtValue() >= rootSize->getZExtValue())
+        break;
+    }
+    if (bottom < kept.size()) {
+      std::unique_ptr<SparseStorage<ref<ConstantExpr>>> values(
+          constantSource->constantValues->clone());
+      for (size_t i = bottom; i < kept.size(); ++i)
+        values->store(cast<ConstantExpr>(kept[i]->index)->getZExtValue(),
+                      cast<ConstantExpr>(kept[i]->value));
+      newRoot = Array::create(root->size,
+                              SourceBuilder::constant(values.release()),
+                              root->getDomain(), root->getRange());
+      kept.resize(bottom);
+    }
+  }
+
+  if (!dropped && newRoot == root) {
+    head->compactedSize = head->size;
+    return;
+  }
+
+  ref<UpdateNode> newHead;
+  for (auto it = kept.rbegin(); it != kept.rend(); ++it)
+    newHead = new UpdateNode(newHead, (*it)->index, (*it)->value);
+  root = newRoot;
+  head = newHead;
+  if (head)
+    head->compactedSize = head->size;
 }
 
 int UpdateList::compare(const UpdateList &b) const {
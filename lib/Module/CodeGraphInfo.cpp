@@ -147,6 +147,53 @@ void CodeGraphInfo::calculateFunctionBlocks(KFunction *kf) {
   }
 }
 
+// Upper bounds on the blocks in a region and on the exit candidates tried.
+static const unsigned MaxRegionSize = 64;
+static const unsigned MaxRegionExitCandidates = 64;
+
+/// Collects the blocks reachable from `kb` without passing `exit`. Fails if
+/// one of them is on a cycle or leaves the function.
+static bool collectRegion(KBlock *kb, KBlock *exit, KBlockSet &region,
+                          KBlockSet &onPath) {
+  onPath.insert(kb);
+  KBlockSet successors = kb->successors();
+  if (successors.empty())
+    return false;
+  for (auto succ : successors) {
+    if (succ == exit)
+      continue;
+    if (onPath.count(succ))
+      return false;
+    if (region.count(succ))
+      continue;
+    region.insert(succ);
+    if (region.size() > MaxRegionSize ||
+        !collectRegion(succ, exit, region, onPath))
+      return false;
+  }
+  onPath.erase(kb);
+  return true;
+}
+
+void CodeGraphInfo::calculateRegion(KBlock *kb) {
+  auto &region = blockRegions[kb];
+  getDistance(kb);
+  unsigned candidates = 0;
+  for (auto &candidate : blockSortedDistance.at(kb)) {
+    if (candidate.first == kb)
+      continue;
+    if (++candidates > MaxRegionExitCandidates)
+      break;
+    KBlockSet blocks;
+    KBlockSet onPath;
+    if (collectRegion(kb, candidate.first, blocks, onPath)) {
+      region = {candidate.first, std::move(blocks)};
+      return;
+    }
+  }
+  region = {nullptr, {}};
+}
+
 const BlockDistanceMap &CodeGraphInfo::getDistance(KBlock *b) {
   if (blockDistance.count(b) == 0)
     calculateDistance(b);
@@ -159,6 +206,18 @@ bool CodeGraphInfo::hasCycle(KBlock *kb) {
   return blockCycles.count(kb);
 }
 
+KBlock *CodeGraphInfo::getRegionExit(KBlock *kb) {
+  if (blockRegions.count(kb) == 0)
+    calculateRegion(kb);
+  return blockRegions.at(kb).first;
+}
+
+const KBlockSet &CodeGraphInfo::getRegion(KBlock *kb) {
+  if (blockRegions.count(kb) == 0)
+    calculateRegion(kb);
+  return blockRegions.at(kb).second;
+}
+
 const BlockDistanceMap &CodeGraphInfo::getBackwardDistance(KBlock *kb) {
   if (blockBackwardDistance.count(kb) == 0)
     calculateBackwardDistance(kb);
@@ -27,15 +27,56 @@
 
 #include "klee/Solver/Solver.h"
 #include "klee/Solver/SolverCmdLine.h"
+#include "klee/Solver/SolverStats.h"
 #include "klee/Support/ErrorHandling.h"
 
 #include "llvm/Support/ErrorHandling.h"
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace klee {
 
+static std::unique_ptr<Solver> createPortfolioCoreSolver() {
+  std::vector<CoreSolverType> types(PortfolioSolvers.begin(),
+                                    PortfolioSolvers.end());
+  if (types.empty())
+    types = {STP_SOLVER, Z3_SOLVER, BITWUZLA_SOLVER};
+
+  std::vector<std::pair<std::unique_ptr<Solver>, Statistic *>> members;
+  for (CoreSolverType type : types) {
+    Statistic *wins = nullptr;
+    switch (type) {
+    case STP_SOLVER:
+      wins = &stats::portfolioSTPWins;
+      break;
+    case Z3_SOLVER:
+      wins = &stats::portfolioZ3Wins;
+      break;
+    case BITWUZLA_SOLVER:
+      wins = &stats::portfolioBitwuzlaWins;
+      break;
+    default:
+      llvm_unreachable("Unsupported portfolio backend");
+    }
+    if (auto solver = createCoreSolver(type))
+      members.emplace_back(std::move(solver), wins);
+  }
+
+  if (members.empty()) {
+    klee_message("No backend available for the portfolio solver");
+    return nullptr;
+  }
+  if (members.size() == 1) {
+    klee_warning("Only one portfolio backend available, not racing");
+    return std::move(members.front().first);
+  }
+  klee_message("Using portfolio of %zu solver backends", members.size());
+  return createPortfolioSolver(std::move(members));
+}
+
 std::unique_ptr<Solver> createCoreSolver(CoreSolverType cst) {
   bool isTreeSolver = (cst == Z3_TREE_SOLVER || cst == BITWUZLA_TREE_SOLVER);
   if (!isTreeSolver && MaxSolversApproxTreeInc > 0)
@@ -106,6 +147,8 @@ std::unique_ptr<Solver> createCoreSolver(CoreSolverType cst) {
     klee_message("Not compiled with Bitwuzla support");
     return NULL;
 #endif
+  case PORTFOLIO_SOLVER:
+    return createPortfolioCoreSolver();
   case NO_SOLVER:
     klee_message("Invalid solver");
     return NULL;
@@ -0,0 +1,549 @@
+//===-- PortfolioSolver.cpp -------------------------------------*- C++ -*-===//
+//
+//                     The KLEE Symbolic Virtual Machine
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "klee/Expr/Constraints.h"
+#include "klee/Expr/Expr.h"
+#include "klee/Solver/Solver.h"
+#include "klee/Solver/SolverImpl.h"
+#include "klee/Solver/SolverStats.h"
+#include "klee/Statistics/Statistic.h"
+#include "klee/Statistics/TimerStatIncrementer.h"
+#include "klee/Support/ErrorHandling.h"
+
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Errno.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace klee;
+
+namespace {
+
+/// Answer of a portfolio member, serialized by the worker which computed it
+/// and read back by the parent process. Expressions can not be passed
+/// between processes, so constraints are referred to by their position in
+/// the query and arrays by their position in the list of symbolic objects.
+class Answer {
+  std::string data;
+  size_t pos = 0;
+
+public:
+  Answer() = default;
+  explicit Answer(std::string data) : data(std::move(data)) {}
+
+  const std::string &raw() const { return data; }
+
+  template <typename T> void put(const T &value) {
+    data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  template <typename T> bool get(T &value) {
+    if (pos + sizeof(T) > data.size())
+      return false;
+    std::memcpy(&value, data.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+  }
+
+  void putConstant(const ref<ConstantExpr> &ce) {
+    const llvm::APInt &value = ce->getAPValue();
+    put<unsigned>(value.getBitWidth());
+    put<unsigned>(value.getNumWords());
+    for (unsigned i = 0; i < value.getNumWords(); ++i)
+      put<uint64_t>(value.getRawData()[i]);
+  }
+
+  bool getConstant(ref<ConstantExpr> &ce) {
+    unsigned width, numWords;
+    if (!get(width) || !get(numWords))
+      return false;
+    std::vector<uint64_t> words(numWords);
+    for (auto &word : words)
+      if (!get(word))
+        return false;
+    ce = ConstantExpr::alloc(llvm::APInt(width, words));
+    return true;
+  }
+
+  void putValues(const SparseStorageImpl<unsigned char> &values) {
+    put(values.defaultV());
+    put<uint64_t>(values.storage().size());
+    for (const auto &[index, value] : values.storage()) {
+      put<uint64_t>(index);
+      put(value);
+    }
+  }
+
+  bool getValues(SparseStorageImpl<unsigned char> &values) {
+    unsigned char defaultValue;
+    uint64_t size;
+    if (!get(defaultValue) || !get(size))
+      return false;
+    values = SparseStorageImpl<unsigned char>(defaultValue);
+    for (uint64_t i = 0; i < size; ++i) {
+      uint64_t index;
+      unsigned char value;
+      if (!get(index) || !get(value))
+        return false;
+      values.store(index, value);
+    }
+    return true;
+  }
+
+  /// Stores the constraints of `core` as positions in the query. If the core
+  /// mentions constraints which are not part of the query (e.g. simplified
+  /// ones), all constraints of the query are stored instead, which is still
+  /// a valid, if larger, core.
+  void putCore(const ValidityCore &core, const Query &query) {
+    const auto &constraints = query.constraints.cs();
+    std::vector<uint64_t> positions;
+    uint64_t position = 0;
+    for (const auto &constraint : constraints) {
+      if (core.constraints.count(constraint))
+        positions.push_back(position);
+      ++position;
+    }
+    if (positions.size() != core.constraints.size()) {
+      positions.clear();
+      for (position = 0; position < constraints.size(); ++position)
+        positions.push_back(position);
+    }
+    put<uint64_t>(positions.size());
+    for (auto p : positions)
+      put(p);
+  }
+
+  bool getCore(ValidityCore &core, const Query &query) {
+    const auto &constraints = query.constraints.cs();
+    uint64_t size;
+    if (!get(size))
+      return false;
+    ValidityCore::constraints_typ coreConstraints;
+    auto it = constraints.begin();
+    uint64_t current = 0;
+    for (uint64_t i = 0; i < size; ++i) {
+      uint64_t position;
+      if (!get(position) || position < current ||
+          position >= constraints.size())
+        return false;
+      std::advance(it, position - current);
+      current = position;
+      coreConstraints.insert(*it);
+    }
+    core = ValidityCore(coreConstraints, query.expr);
+    return true;
+  }
+};
+
+struct PortfolioMember {
+  std::unique_ptr<Solver> solver;
+  Statistic *wins;
+};
+
+class PortfolioSolverImpl : public SolverImpl {
+private:
+  std::vector<PortfolioMember> members;
+  SolverRunStatus runStatusCode;
+
+  /// Computes the answer of a single member. Returns false if the member
+  /// failed to answer the query.
+  typedef std::function<bool(SolverImpl &, Answer &)> Work;
+
+  /// Runs `work` for every member in a forked worker and waits for the first
+  /// worker which succeeds. The remaining workers are killed.
+  bool race(const Work &work, Answer &answer);
+
+public:
+  PortfolioSolverImpl(
+      std::vector<std::pair<std::unique_ptr<Solver>, Statistic *>> solvers);
+
+  bool computeValidity(const Query &, PartialValidity &result);
+  bool computeTruth(const Query &, bool &isValid);
+  bool computeValue(const Query &, ref<Expr> &result);
+  bool
+  computeInitialValues(const Query &, const std::vector<const Array *> &objects,
+                       std::vector<SparseStorageImpl<unsigned char>> &values,
+                       bool &hasSolution);
+  bool check(const Query &query, ref<SolverResponse> &result);
+  bool computeValidityCore(const Query &query, ValidityCore &validityCore,
+                           bool &isValid);
+  bool computeMinimalUnsignedValue(const Query &query,
+                                   ref<ConstantExpr> &result);
+  SolverRunStatus getOperationStatusCode();
+  std::string getConstraintLog(const Query &query);
+  void setCoreSolverTimeout(time::Span timeout);
+  void notifyStateTermination(std::uint32_t id);
+};
+
+PortfolioSolverImpl::PortfolioSolverImpl(
+    std::vector<std::pair<std::unique_ptr<Solver>, Statistic *>> solvers)
+    : runStatusCode(SOLVER_RUN_STATUS_FAILURE) {
+  for (auto &[solver, wins] : solvers)
+    members.push_back({std::move(solver), wins});
+}
+
+void writeAll(int fd, const std::string &data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t res = write(fd, data.data() + written, data.size() - written);
+    if (res < 0) {
+      if (errno == EINTR)
+        continue;
+      return;
+    }
+    written += res;
+  }
+}
+
+void reapWorker(pid_t pid) {
+  int status;
+  pid_t res;
+  do {
+    res = waitpid(pid, &status, 0);
+  } while (res < 0 && errno == EINTR);
+}
+
+bool PortfolioSolverImpl::race(const Work &work, Answer &answer) {
+  TimerStatIncrementer t(stats::queryTime);
+  ++stats::solverQueries;
+  runStatusCode = SOLVER_RUN_STATUS_FAILURE;
+
+  struct Worker {
+    PortfolioMember *member;
+    pid_t pid;
+    int fd;
+    std::string data;
+  };
+  std::vector<Worker> workers;
+  workers.reserve(members.size());
+
+  fflush(stdout);
+  fflush(stderr);
+
+  for (auto &member : members) {
+    int fds[2];
+    if (pipe(fds) == -1) {
+      klee_warning_once(0, "pipe failed (for portfolio solver) - %s",
+                        llvm::sys::StrError(errno).c_str());
+      continue;
+    }
+    pid_t pid = fork();
+    // - error
+    if (pid == -1) {
+      klee_warning_once(0, "fork failed (for portfolio solver) - %s",
+                        llvm::sys::StrError(errno).c_str());
+      close(fds[0]);
+      close(fds[1]);
+      continue;
+    }
+    // - child (member)
+    if (pid == 0) {
+      close(fds[0]);
+      for (auto &worker : workers)
+        close(worker.fd);
+      Answer payload;
+      bool success = work(*member.solver->impl, payload);
+      Answer reply;
+      reply.put(member.solver->impl->getOperationStatusCode());
+      reply.put(success);
+      writeAll(fds[1], reply.raw() + payload.raw());
+      _exit(0);
+    }
+    // - parent
+    close(fds[1]);
+    workers.push_back({&member, pid, fds[0], {}});
+  }
+
+  if (workers.empty()) {
+    runStatusCode = SOLVER_RUN_STATUS_FORK_FAILED;
+    return false;
+  }
+
+  Worker *winner = nullptr;
+  unsigned running = workers.size();
+  while (!winner && running) {
+    std::vector<struct pollfd> fds;
+    std::vector<Worker *> polled;
+    for (auto &worker : workers) {
+      if (worker.fd != -1) {
+        fds.push_back({worker.fd, POLLIN, 0});
+        polled.push_back(&worker);
+      }
+    }
+
+    int ready;
+    do {
+      ready = ::poll(fds.data(), fds.size(), -1);
+    } while (ready < 0 && errno == EINTR);
+    if (ready < 0) {
+      runStatusCode = SOLVER_RUN_STATUS_INTERRUPTED;
+      break;
+    }
+
+    for (size_t i = 0; i < fds.size() && !winner; ++i) {
+      if (!fds[i].revents)
+        continue;
+      Worker &worker = *polled[i];
+      char buffer[4096];
+      ssize_t received = read(worker.fd, buffer, sizeof(buffer));
+      if (received > 0) {
+        worker.data.append(buffer, received);
+        continue;
+      }
+      if (received < 0 && errno == EINTR)
+        continue;
+
+      // The worker has finished (or crashed).
+      close(worker.fd);
+      worker.fd = -1;
+      reapWorker(worker.pid);
+      --running;
+
+      Answer reply(std::move(worker.data));
+      SolverRunStatus status;
+      bool success;
+      if (!reply.get(status) || !reply.get(success)) {
+        runStatusCode = SOLVER_RUN_STATUS_UNEXPECTED_EXIT_CODE;
+        continue;
+      }
+      runStatusCode = status;
+      if (success) {
+        winner = &worker;
+        answer = std::move(reply);
+      }
+    }
+  }
+
+  for (auto &worker : workers) {
+    if (worker.fd == -1)
+      continue;
+    kill(worker.pid, SIGKILL);
+    close(worker.fd);
+    reapWorker(worker.pid);
+  }
+
+  if (!winner)
+    return false;
+  ++*winner->member->wins;
+  return true;
+}
+
+bool PortfolioSolverImpl::computeValidity(const Query &query,
+                                          PartialValidity &result) {
+  Answer answer;
+  if (!race(
+          [&query](SolverImpl &solver, Answer &out) {
+            PartialValidity validity;
+            if (!solver.computeValidity(query, validity))
+              return false;
+            out.put(validity);
+            return true;
+          },
+          answer))
+    return false;
+  return answer.get(result);
+}
+
+bool PortfolioSolverImpl::computeTruth(const Query &query, bool &isValid) {
+  Answer answer;
+  if (!race(
+          [&query](SolverImpl &solver, Answer &out) {
+            bool valid;
+            if (!solver.computeTruth(query, valid))
+              return false;
+            out.put(valid);
+            return true;
+          },
+          answer))
+    return false;
+  return answer.get(isValid);
+}
+
+bool PortfolioSolverImpl::computeValue(const Query &query, ref<Expr> &result) {
+  ++stats::queryCounterexamples;
+  Answer answer;
+  if (!race(
+          [&query](SolverImpl &solver, Answer &out) {
+            ref<Expr> value;
+            if (!solver.computeValue(query, value) || !isa<ConstantExpr>(value))
+              return false;
+            out.putConstant(cast<ConstantExpr>(value));
+            return true;
+          },
+          answer))
+    return false;
+  ref<ConstantExpr> value;
+  if (!answer.getConstant(value))
+    return false;
+  result = value;
+  return true;
+}
+
+bool PortfolioSolverImpl::computeInitialValues(
+    const Query &query, const std::vector<const Array *> &objects,
+    std::vector<SparseStorageImpl<unsigned char>> &values, bool &hasSolution) {
+  ++stats::queryCounterexamples;
+  Answer answer;
+  if (!race(
+          [&query, &objects](SolverImpl &solver, Answer &out) {
+            std::vector<SparseStorageImpl<unsigned char>> values;
+            bool hasSolution;
+            if (!solver.computeInitialValues(query, objects, values,
+                                             hasSolution))
+              return false;
+            out.put(hasSolution);
+            if (hasSolution)
+              for (const auto &value : values)
+                out.putValues(value);
+            return true;
+          },
+          answer))
+    return false;
+  if (!answer.get(hasSolution))
+    return false;
+  if (hasSolution) {
+    values.resize(objects.size());
+    for (auto &value : values)
+      if (!answer.getValues(value))
+        return false;
+  }
+  return true;
+}
+
+bool PortfolioSolverImpl::check(const Query &query,
+                                ref<SolverResponse> &result) {
+  ++stats::queryCounterexamples;
+  ++stats::queryValidityCores;
+  std::vector<const Array *> objects;
+  findSymbolicObjects(query, objects);
+  Answer answer;
+  if (!race(
+          [&query, &objects](SolverImpl &solver, Answer &out) {
+            ref<SolverResponse> response;
+            if (!solver.check(query, response))
+              return false;
+            out.put(response->getResponseKind());
+            if (auto valid = dyn_cast<ValidResponse>(response)) {
+              out.putCore(valid->validityCore(), query);
+            } else if (auto invalid = dyn_cast<InvalidResponse>(response)) {
+              std::vector<SparseStorageImpl<unsigned char>> values;
+              invalid->initialValuesFor(objects, values);
+              for (const auto &value : values)
+                out.putValues(value);
+            }
+            return true;
+          },
+          answer))
+    return false;
+
+  SolverResponse::ResponseKind kind;
+  if (!answer.get(kind))
+    return false;
+  switch (kind) {
+  case SolverResponse::Valid: {
+    ValidityCore core;
+    if (!answer.getCore(core, query))
+      return false;
+    result = new ValidResponse(core);
+    return true;
+  }
+  case SolverResponse::Invalid: {
+    std::vector<SparseStorageImpl<unsigned char>> values(objects.size());
+    for (auto &value : values)
+      if (!answer.getValues(value))
+        return false;
+    result = new InvalidResponse(objects, values);
+    return true;
+  }
+  case SolverResponse::Unknown:
+    result = new UnknownResponse();
+    return true;
+  }
+  return false;
+}
+
+bool PortfolioSolverImpl::computeValidityCore(const Query &query,
+                                              ValidityCore &validityCore,
+                                              bool &isValid) {
+  ++stats::queryValidityCores;
+  Answer answer;
+  if (!race(
+          [&query](SolverImpl &solver, Answer &out) {
+            ValidityCore core;
+            bool valid;
+            if (!solver.computeValidityCore(query, core, valid))
+              return false;
+            out.put(valid);
+            if (valid)
+              out.putCore(core, query);
+            return true;
+          },
+          answer))
+    return false;
+  if (!answer.get(isValid))
+    return false;
+  return !isValid || answer.getCore(validityCore, query);
+}
+
+bool PortfolioSolverImpl::computeMinimalUnsignedValue(
+    const Query &query, ref<ConstantExpr> &result) {
+  Answer answer;
+  if (!race(
+          [&query](SolverImpl &solver, Answer &out) {
+            ref<ConstantExpr> value;
+            if (!solver.computeMinimalUnsignedValue(query, value))
+              return false;
+            out.putConstant(value);
+            return true;
+          },
+          answer))
+    return false;
+  return answer.getConstant(result);
+}
+
+SolverImpl::SolverRunStatus PortfolioSolverImpl::getOperationStatusCode() {
+  return runStatusCode;
+}
+
+std::string PortfolioSolverImpl::getConstraintLog(const Query &query) {
+  return members.front().solver->impl->getConstraintLog(query);
+}
+
+void PortfolioSolverImpl::setCoreSolverTimeout(time::Span timeout) {
+  for (auto &member : members)
+    member.solver->impl->setCoreSolverTimeout(timeout);
+}
+
+void PortfolioSolverImpl::notifyStateTermination(std::uint32_t id) {
+  for (auto &member : members)
+    member.solver->impl->notifyStateTermination(id);
+}
+
+} // namespace
+
+namespace klee {
+std::unique_ptr<Solver> createPortfolioSolver(
+    std::vector<std::pair<std::unique_ptr<Solver>, Statistic *>> solvers) {
+  return std::make_unique<Solver>(
+      std::make_unique<PortfolioSolverImpl>(std::move(solvers)));
+}
+} // namespace klee
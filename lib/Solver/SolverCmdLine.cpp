@@ -231,9 +231,21 @@ cl::opt<CoreSolverType> CoreSolverToUse(
         clEnumValN(METASMT_SOLVER, "metasmt", "metaSMT" METASMT_IS_DEFAULT_STR),
         clEnumValN(DUMMY_SOLVER, "dummy", "Dummy solver"),
         clEnumValN(Z3_SOLVER, "z3", "Z3" Z3_IS_DEFAULT_STR),
-        clEnumValN(Z3_TREE_SOLVER, "z3-tree", "Z3 tree-incremental solver")),
+        clEnumValN(Z3_TREE_SOLVER, "z3-tree", "Z3 tree-incremental solver"),
+        clEnumValN(PORTFOLIO_SOLVER, "portfolio",
+                   "Race the backends given by --portfolio-solvers on every "
+                   "query")),
     cl::init(DEFAULT_CORE_SOLVER), cl::cat(SolvingCat));
 
+cl::list<CoreSolverType> PortfolioSolvers(
+    "portfolio-solvers",
+    cl::desc("Comma-separated list of backends raced by the portfolio solver "
+             "(default=all available of stp, z3 and bitwuzla)"),
+    cl::values(clEnumValN(STP_SOLVER, "stp", "STP"),
+               clEnumValN(Z3_SOLVER, "z3", "Z3"),
+               clEnumValN(BITWUZLA_SOLVER, "bitwuzla", "Bitwuzla")),
+    cl::CommaSeparated, cl::cat(SolvingCat));
+
 cl::opt<CoreSolverType> DebugCrossCheckCoreSolverWith(
     "debug-crosscheck-core-solver",
     cl::desc("Specifiy a solver to use for crosschecking the results of the "
@@ -26,6 +26,9 @@ Statistic stats::validQueriesSize("ValidQueriesSize", "VQsize");
 Statistic stats::validityCoresSize("ValidityCoresSize", "VCsize");
 Statistic stats::queryValidityCores("QueryValidityCores", "QVcores");
 Statistic stats::queryTime("QueryTime", "Qtime");
+Statistic stats::portfolioSTPWins("PortfolioSTPWins", "PfSTP");
+Statistic stats::portfolioZ3Wins("PortfolioZ3Wins", "PfZ3");
+Statistic stats::portfolioBitwuzlaWins("PortfolioBitwuzlaWins", "PfBtor");
 
 #ifdef KLEE_ARRAY_DEBUG
 Statistic stats::arrayHashTime("ArrayHashTime", "AHtime");
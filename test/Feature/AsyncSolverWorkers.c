@@ -0,0 +1,17 @@
+// RUN: %clang %s -emit-llvm %O0opt -c -o %t1.bc
+// RUN: rm -rf %t.klee-out
+// RUN: %klee --output-dir=%t.klee-out --use-guided-search=none --async-solver-workers=2 %t1.bc 2>&1 | FileCheck %s
+#include "klee/klee.h"
+
+int main() {
+  char buf[3];
+  int count = 0;
+  klee_make_symbolic(buf, sizeof(buf), "buf");
+  for (int i = 0; i < 3; ++i) {
+    if (buf[i] > 'a')
+      ++count;
+  }
+  return count;
+}
+
+// CHECK: KLEE: done: completed paths = 8
@@ -0,0 +1,95 @@
+; RUN: %llvmas %s -o %t.bc
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -optimize=false %t.bc 2>&1 | FileCheck %s
+;
+; Calls memory functions on concrete objects, which must run without their
+; bodies, and memcmp on a symbolic byte, which must run its body. The bodies
+; abort, except the one of memcmp, which returns 42.
+
+; CHECK: KLEE: done: completed paths = 1
+
+declare void @klee_make_symbolic(i8*, i64, i8*)
+declare void @abort()
+
+@src = global [8 x i8] c"abcdefg\00"
+@dst = global [8 x i8] zeroinitializer
+@.name = private constant [2 x i8] c"s\00"
+
+define i8* @memcpy(i8* %d, i8* %s, i64 %n) {
+  call void @abort()
+  unreachable
+}
+
+define i8* @memmove(i8* %d, i8* %s, i64 %n) {
+  call void @abort()
+  unreachable
+}
+
+define i8* @memset(i8* %d, i32 %c, i64 %n) {
+  call void @abort()
+  unreachable
+}
+
+define i64 @strlen(i8* %s) {
+  call void @abort()
+  unreachable
+}
+
+define i32 @memcmp(i8* %a, i8* %b, i64 %n) {
+  ret i32 42
+}
+
+define i32 @main() {
+entry:
+  %srcp = getelementptr [8 x i8], [8 x i8]* @src, i64 0, i64 0
+  %dstp = getelementptr [8 x i8], [8 x i8]* @dst, i64 0, i64 0
+  %dst1 = getelementptr [8 x i8], [8 x i8]* @dst, i64 0, i64 1
+  %dst2 = getelementptr [8 x i8], [8 x i8]* @dst, i64 0, i64 2
+  %dst4 = getelementptr [8 x i8], [8 x i8]* @dst, i64 0, i64 4
+
+  ; dst = "abcdefg"
+  %r = call i8* @memcpy(i8* %dstp, i8* %srcp, i64 8)
+  %samer = icmp eq i8* %r, %dstp
+  %len = call i64 @strlen(i8* %dstp)
+  %oklen = icmp eq i64 %len, 7
+
+  ; dst = "abxxxfg", only the low byte of the value is written
+  call i8* @memset(i8* %dst2, i32 376, i64 3)
+  %cmp = call i32 @memcmp(i8* %dstp, i8* %srcp, i64 8)
+  %okcmp = icmp eq i32 %cmp, 21
+  %cmpr = call i32 @memcmp(i8* %srcp, i8* %dstp, i64 8)
+  %okcmpr = icmp eq i32 %cmpr, -21
+  %cmpeq = call i32 @memcmp(i8* %dstp, i8* %srcp, i64 2)
+  %okcmpeq = icmp eq i32 %cmpeq, 0
+
+  ; dst = "aabxxfg"
+  call i8* @memmove(i8* %dst1, i8* %dstp, i64 4)
+  %b1 = load i8, i8* %dst1
+  %b2 = load i8, i8* %dst2
+  %b4 = load i8, i8* %dst4
+  %ok1 = icmp eq i8 %b1, 97
+  %ok2 = icmp eq i8 %b2, 98
+  %ok4 = icmp eq i8 %b4, 120
+
+  %sym = alloca i8
+  call void @klee_make_symbolic(i8* %sym, i64 1, i8* getelementptr ([2 x i8], [2 x i8]* @.name, i64 0, i64 0))
+  %cmps = call i32 @memcmp(i8* %sym, i8* %srcp, i64 1)
+  %okcmps = icmp eq i32 %cmps, 42
+
+  %c1 = and i1 %samer, %oklen
+  %c2 = and i1 %c1, %okcmp
+  %c3 = and i1 %c2, %okcmpr
+  %c4 = and i1 %c3, %okcmpeq
+  %c5 = and i1 %c4, %ok1
+  %c6 = and i1 %c5, %ok2
+  %c7 = and i1 %c6, %ok4
+  %ok = and i1 %c7, %okcmps
+  br i1 %ok, label %exit, label %fail
+
+fail:
+  call void @abort()
+  unreachable
+
+exit:
+  ret i32 0
+}
@@ -0,0 +1,56 @@
+; RUN: %llvmas %s -o %t.bc
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -optimize=false %t.bc
+;
+; Checks the results of integer instructions on concrete operands, which are
+; computed on inline register values without building expressions.
+
+define void @check(i1 %c) {
+  br i1 %c, label %ok, label %bad
+bad:
+  call void @abort()
+  unreachable
+ok:
+  ret void
+}
+
+define i32 @main() {
+  %a = add i8 200, 100
+  %c1 = icmp eq i8 %a, 44
+  call void @check(i1 %c1)
+  %s = sub i32 0, 1
+  %c2 = icmp slt i32 %s, 0
+  call void @check(i1 %c2)
+  %c3 = icmp ugt i32 %s, 5
+  call void @check(i1 %c3)
+  %sh = ashr i32 %s, 31
+  %c4 = icmp eq i32 %sh, -1
+  call void @check(i1 %c4)
+  %l = lshr i32 %s, 28
+  %c5 = icmp eq i32 %l, 15
+  call void @check(i1 %c5)
+  %t = trunc i32 %s to i8
+  %se = sext i8 %t to i64
+  %c6 = icmp eq i64 %se, -1
+  call void @check(i1 %c6)
+  %ze = zext i8 %t to i64
+  %c7 = icmp eq i64 %ze, 255
+  call void @check(i1 %c7)
+  %m = mul i64 -1, -1
+  %c8 = icmp eq i64 %m, 1
+  call void @check(i1 %c8)
+  %b = xor i1 true, true
+  %c9 = icmp eq i1 %b, false
+  call void @check(i1 %c9)
+  %sl = shl i16 1, 15
+  %c10 = icmp slt i16 %sl, 0
+  call void @check(i1 %c10)
+  %bg = sext i32 -5 to i128
+  %c11 = icmp slt i128 %bg, 0
+  call void @check(i1 %c11)
+  %mn = icmp sle i64 -9223372036854775808, 9223372036854775807
+  call void @check(i1 %mn)
+  ret i32 0
+}
+
+declare void @abort() noreturn nounwind
@@ -0,0 +1,30 @@
+; RUN: %llvmas %s -o %t.bc
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -allocate-determ -allocate-determ-quarantine=0 %t.bc 2>&1 | FileCheck -check-prefix=CHECK-REUSE %s
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -allocate-determ %t.bc 2>&1 | FileCheck -check-prefix=CHECK-QUARANTINE %s
+;
+; Frees an object and allocates one of the same size. Without a quarantine
+; the new object takes the space of the freed one, with the default one it
+; does not.
+
+; CHECK-REUSE: reused:true
+; CHECK-QUARANTINE: reused:false
+
+declare i8* @malloc(i64)
+declare void @free(i8*)
+declare void @klee_print_expr(i8*, ...)
+
+@.name = private constant [7 x i8] c"reused\00"
+
+define i32 @main() {
+entry:
+  %a = call i8* @malloc(i64 32)
+  %aint = ptrtoint i8* %a to i64
+  call void @free(i8* %a)
+  %b = call i8* @malloc(i64 32)
+  %bint = ptrtoint i8* %b to i64
+  %same = icmp eq i64 %aint, %bint
+  call void (i8*, ...) @klee_print_expr(i8* getelementptr ([7 x i8], [7 x i8]* @.name, i64 0, i64 0), i1 %same)
+  ret i32 0
+}
@@ -0,0 +1,68 @@
+; RUN: %llvmas %s -o %t.bc
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -optimize=false -check-div-zero=false -check-overshift=false --jit-concrete-blocks --jit-hot-block-threshold=2 %t.bc 2>&1 | FileCheck %s
+;
+; Runs a hash loop whose body is compiled to native code once it is hot, then
+; the same loop on a symbolic seed, for which the compiled body must be left
+; to the interpreter.
+
+; CHECK-NOT: ASSERTION FAIL
+; CHECK: KLEE: done: completed paths = 1
+; CHECK: KLEE: done: partially completed paths = 0
+
+declare void @abort()
+declare void @klee_make_symbolic(i8*, i64, i8*)
+
+@.name = private constant [5 x i8] c"seed\00"
+
+define void @check(i1 %c) {
+  br i1 %c, label %ok, label %bad
+bad:
+  call void @abort()
+  unreachable
+ok:
+  ret void
+}
+
+define i32 @hash(i32 %seed) {
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %h = phi i32 [ %seed, %entry ], [ %h.next, %loop ]
+  %i7 = mul i32 %i, 7
+  %b = and i32 %i7, 255
+  %x0 = xor i32 %h, %b
+  %x = mul i32 %x0, 16777619
+  %low = and i32 %i, 15
+  %d = add i32 %low, 1
+  %q = udiv i32 %x, %d
+  %sh = and i32 %i, 31
+  %s = shl i32 %x, %sh
+  %x7 = lshr i32 %x, 7
+  %t0 = xor i32 %q, %s
+  %t = xor i32 %t0, %x7
+  %odd8 = trunc i32 %i to i8
+  %odd1 = and i8 %odd8, 1
+  %odd = icmp ne i8 %odd1, 0
+  %h.next = select i1 %odd, i32 %t, i32 %x
+  %i.next = add i32 %i, 1
+  %cont = icmp ult i32 %i.next, 300
+  br i1 %cont, label %loop, label %exit
+exit:
+  ret i32 %h.next
+}
+
+define i32 @main() {
+  %h = call i32 @hash(i32 -2128831035)
+  %ok = icmp eq i32 %h, -1174627643
+  call void @check(i1 %ok)
+
+  %seed.addr = alloca i32
+  %seed.ptr = bitcast i32* %seed.addr to i8*
+  %name = getelementptr [5 x i8], [5 x i8]* @.name, i64 0, i64 0
+  call void @klee_make_symbolic(i8* %seed.ptr, i64 4, i8* %name)
+  %seed = load i32, i32* %seed.addr
+  %hs = call i32 @hash(i32 %seed)
+  ret i32 0
+}
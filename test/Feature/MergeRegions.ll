@@ -0,0 +1,61 @@
+; RUN: %llvmas %s -o %t.bc
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -optimize=false --merge-regions %t.bc 2>&1 | FileCheck %s
+;
+; Counts the symbolic bytes above a bound in a loop of eight independent
+; branches. The two states forked by each branch are merged at the latch,
+; so a single path reaches the end instead of 256.
+
+; CHECK-NOT: ASSERTION FAIL
+; CHECK: KLEE: done: completed paths = 1
+; CHECK: KLEE: done: partially completed paths = 0
+
+declare void @abort()
+declare void @klee_make_symbolic(i8*, i64, i8*)
+
+@.name = private constant [2 x i8] c"x\00"
+@last = global i32 0
+
+define i32 @main() {
+entry:
+  %buf = alloca [8 x i8]
+  %p = getelementptr [8 x i8], [8 x i8]* %buf, i32 0, i32 0
+  %name = getelementptr [2 x i8], [2 x i8]* @.name, i32 0, i32 0
+  call void @klee_make_symbolic(i8* %p, i64 8, i8* %name)
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %count = phi i32 [ 0, %entry ], [ %count.next, %latch ]
+  %idx = sext i32 %i to i64
+  %q = getelementptr i8, i8* %p, i64 %idx
+  %c = load i8, i8* %q
+  %above = icmp ugt i8 %c, 100
+  br i1 %above, label %then, label %latch
+then:
+  %count.inc = add i32 %count, 1
+  store i32 %count.inc, i32* @last
+  br label %latch
+latch:
+  %count.next = phi i32 [ %count.inc, %then ], [ %count, %loop ]
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, 8
+  br i1 %done, label %check, label %loop
+check:
+  ; The merged memory and registers must agree on every path
+  %last.v = load i32, i32* @last
+  %same = icmp eq i32 %last.v, %count.next
+  br i1 %same, label %bound, label %bad
+bound:
+  %in.range = icmp ule i32 %count.next, 8
+  br i1 %in.range, label %split, label %bad
+split:
+  %all = icmp eq i32 %count.next, 8
+  br i1 %all, label %exit.all, label %exit
+bad:
+  call void @abort()
+  unreachable
+exit.all:
+  ret i32 1
+exit:
+  ret i32 0
+}
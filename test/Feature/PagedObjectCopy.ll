@@ -0,0 +1,53 @@
+; RUN: %llvmas %s -o %t.bc
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -optimize=false %t.bc 2>&1 | FileCheck %s
+;
+; Forks on a symbolic byte after writing to a buffer spanning several pages,
+; and writes different values to the same byte of the buffer in both states.
+; Each state must only see its own write, the one before the fork and the
+; zeroes of the pages nobody wrote to.
+
+; CHECK: KLEE: done: completed paths = 2
+
+declare void @klee_make_symbolic(i8*, i64, i8*)
+declare void @abort()
+
+@buf = global [16384 x i8] zeroinitializer
+@.name = private constant [2 x i8] c"x\00"
+
+define i32 @main() {
+entry:
+  %x = alloca i8
+  call void @klee_make_symbolic(i8* %x, i64 1, i8* getelementptr ([2 x i8], [2 x i8]* @.name, i64 0, i64 0))
+  store i8 1, i8* getelementptr ([16384 x i8], [16384 x i8]* @buf, i64 0, i64 100)
+  %xv = load i8, i8* %x
+  %big = icmp ugt i8 %xv, 10
+  br i1 %big, label %then, label %else
+
+then:
+  store i8 2, i8* getelementptr ([16384 x i8], [16384 x i8]* @buf, i64 0, i64 9000)
+  br label %check
+
+else:
+  store i8 3, i8* getelementptr ([16384 x i8], [16384 x i8]* @buf, i64 0, i64 9000)
+  br label %check
+
+check:
+  %expected = select i1 %big, i8 2, i8 3
+  %v = load i8, i8* getelementptr ([16384 x i8], [16384 x i8]* @buf, i64 0, i64 9000)
+  %w = load i8, i8* getelementptr ([16384 x i8], [16384 x i8]* @buf, i64 0, i64 100)
+  %z = load i8, i8* getelementptr ([16384 x i8], [16384 x i8]* @buf, i64 0, i64 16000)
+  %okv = icmp eq i8 %v, %expected
+  %okw = icmp eq i8 %w, 1
+  %okz = icmp eq i8 %z, 0
+  %ok1 = and i1 %okv, %okw
+  %ok = and i1 %ok1, %okz
+  br i1 %ok, label %exit, label %fail
+
+fail:
+  call void @abort()
+  unreachable
+
+exit:
+  ret i32 0
+}
@@ -0,0 +1,78 @@
+; RUN: %llvmas %s -o %t.bc
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -optimize=false %t.bc 2>&1 | FileCheck %s
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -optimize=false --resolution-cache-size=0 %t.bc 2>&1 | FileCheck %s
+;
+; Forks on a symbolic flag and then dereferences, in both states, one of 32
+; heap pointers picked by a symbolic index between 10 and 12. The flag does
+; not constrain the index, so the second state reuses the resolution of the
+; first one, which must find the same three objects as the solver.
+
+; CHECK: KLEE: done: completed paths = 7
+
+declare i8* @malloc(i64)
+declare void @klee_make_symbolic(i8*, i64, i8*)
+declare void @abort()
+
+@ptrs = global [32 x i32*] zeroinitializer
+@side = global i32 0
+@.i = private constant [2 x i8] c"i\00"
+@.c = private constant [2 x i8] c"c\00"
+
+define i32 @main() {
+entry:
+  %i = alloca i32
+  %c = alloca i32
+  br label %loop
+
+loop:
+  %j = phi i64 [ 0, %entry ], [ %j1, %loop ]
+  %m = call i8* @malloc(i64 4)
+  %p = bitcast i8* %m to i32*
+  %jt = trunc i64 %j to i32
+  store i32 %jt, i32* %p
+  %slot = getelementptr [32 x i32*], [32 x i32*]* @ptrs, i64 0, i64 %j
+  store i32* %p, i32** %slot
+  %j1 = add i64 %j, 1
+  %done = icmp eq i64 %j1, 32
+  br i1 %done, label %body, label %loop
+
+body:
+  %ib = bitcast i32* %i to i8*
+  call void @klee_make_symbolic(i8* %ib, i64 4, i8* getelementptr ([2 x i8], [2 x i8]* @.i, i64 0, i64 0))
+  %iv = load i32, i32* %i
+  %k = sub i32 %iv, 10
+  %small = icmp ult i32 %k, 3
+  br i1 %small, label %fork, label %exit
+
+fork:
+  %cb = bitcast i32* %c to i8*
+  call void @klee_make_symbolic(i8* %cb, i64 4, i8* getelementptr ([2 x i8], [2 x i8]* @.c, i64 0, i64 0))
+  %cv = load i32, i32* %c
+  %flag = icmp eq i32 %cv, 0
+  br i1 %flag, label %left, label %right
+
+left:
+  store i32 1, i32* @side
+  br label %deref
+
+right:
+  store i32 2, i32* @side
+  br label %deref
+
+deref:
+  %iz = zext i32 %iv to i64
+  %s = getelementptr [32 x i32*], [32 x i32*]* @ptrs, i64 0, i64 %iz
+  %q = load i32*, i32** %s
+  %v = load i32, i32* %q
+  %ok = icmp eq i32 %v, %iv
+  br i1 %ok, label %exit, label %fail
+
+fail:
+  call void @abort()
+  unreachable
+
+exit:
+  ret i32 0
+}
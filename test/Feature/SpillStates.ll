@@ -0,0 +1,74 @@
+; RUN: %llvmas %s -o %t.bc
+; RUN: rm -rf %t.klee-out
+; RUN: %klee -exit-on-error -output-dir=%t.klee-out -optimize=false --search=bfs --max-resident-states=1 %t.bc 2>&1 | FileCheck %s
+; RUN: test -f %t.klee-out/spilled-states.bin
+;
+; Every state counts the symbolic bytes above a bound both in a register and
+; in a global, and stores the byte to the global buffer. With a single
+; resident state, all other states are spilled and reloaded in between, and
+; their registers and memory must still agree at the end.
+
+; CHECK-NOT: ASSERTION FAIL
+; CHECK: KLEE: done: completed paths = 16
+; CHECK: KLEE: done: partially completed paths = 0
+
+declare void @abort()
+declare void @klee_make_symbolic(i8*, i64, i8*)
+
+@.name = private constant [2 x i8] c"x\00"
+@count = global i32 0
+@buf = global [4 x i8] zeroinitializer
+
+define i32 @main() {
+entry:
+  %sym = alloca [4 x i8]
+  %p = getelementptr [4 x i8], [4 x i8]* %sym, i32 0, i32 0
+  %name = getelementptr [2 x i8], [2 x i8]* @.name, i32 0, i32 0
+  call void @klee_make_symbolic(i8* %p, i64 4, i8* %name)
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  %sum = phi i32 [ 0, %entry ], [ %sum.next, %latch ]
+  %idx = sext i32 %i to i64
+  %q = getelementptr i8, i8* %p, i64 %idx
+  %c = load i8, i8* %q
+  %above = icmp ugt i8 %c, 100
+  br i1 %above, label %taken, label %latch
+
+taken:
+  %old = load i32, i32* @count
+  %new = add i32 %old, 1
+  store i32 %new, i32* @count
+  %slot = getelementptr [4 x i8], [4 x i8]* @buf, i64 0, i64 %idx
+  store i8 %c, i8* %slot
+  br label %latch
+
+latch:
+  %step = phi i32 [ 1, %taken ], [ 0, %loop ]
+  %sum.next = add i32 %sum, %step
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, 4
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %final = load i32, i32* @count
+  %same = icmp eq i32 %final, %sum.next
+  br i1 %same, label %check, label %fail
+
+check:
+  %b0 = getelementptr [4 x i8], [4 x i8]* @buf, i64 0, i64 0
+  %v0 = load i8, i8* %b0
+  %c0 = load i8, i8* %p
+  %set0 = icmp ne i8 %v0, 0
+  %differs0 = icmp ne i8 %v0, %c0
+  %bad = and i1 %set0, %differs0
+  br i1 %bad, label %fail, label %ok
+
+ok:
+  ret i32 0
+
+fail:
+  call void @abort()
+  unreachable
+}
@@ -9,10 +9,17 @@
 
 #include "gtest/gtest.h"
 
+#include "klee/Config/config.h"
 #include "klee/Expr/ArrayCache.h"
+#include "klee/Expr/Constraints.h"
 #include "klee/Expr/Expr.h"
+#include "klee/Expr/IndependentSet.h"
 #include "klee/Expr/SourceBuilder.h"
 
+#ifdef KLEE_THREAD_SAFE_EXPR
+#include <thread>
+#endif
+
 using namespace klee;
 
 namespace {
@@ -287,4 +294,178 @@ TEST(ExprTest, ReadExprFoldingSymbolicIndexUpdate) {
     EXPECT_EQ(Expr::Read, read.get()->getKind());
   }
 }
+
+TEST(ExprTest, ReadExprLongUpdateList) {
+  unsigned size = 1024;
+  const Array *array =
+      Array::create(ConstantExpr::create(size, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::makeSymbolic("arr", 4));
+  const Array *values =
+      Array::create(ConstantExpr::create(size, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::makeSymbolic("arr", 5));
+
+  auto valueAt = [values](unsigned i) {
+    return ReadExpr::createTempRead(values, Expr::Int8,
+                                    ConstantExpr::create(i, Expr::Int32));
+  };
+
+  // Symbolic values at concrete indices, with one update at a symbolic index
+  // in the middle
+  UpdateList ul(array, 0);
+  for (unsigned i = 0; i < 1000; ++i) {
+    if (i == 500)
+      ul.extend(ReadExpr::createTempRead(values, Expr::Int32),
+                ConstantExpr::create(0, Expr::Int8));
+    ul.extend(ConstantExpr::create(i, Expr::Int32), valueAt(i));
+  }
+  EXPECT_TRUE(ul.head->isIndexed());
+
+  for (unsigned i = 0; i < size; ++i) {
+    ref<Expr> read = ReadExpr::create(ul, ConstantExpr::create(i, Expr::Int32));
+    if (i >= 500 && i < 1000) {
+      // Written above the update at a symbolic index
+      EXPECT_EQ(valueAt(i), read);
+    } else {
+      // May have been overwritten at the symbolic index
+      ASSERT_EQ(Expr::Read, read->getKind());
+      EXPECT_EQ(array, cast<ReadExpr>(read)->updates.root);
+      EXPECT_EQ(501u, cast<ReadExpr>(read)->updates.getSize());
+    }
+  }
+}
+
+TEST(ExprTest, UpdateListCompaction) {
+  unsigned size = 16;
+  SparseStorageImpl<ref<ConstantExpr>> Contents(
+      ConstantExpr::create(0, Expr::Int8));
+  const Array *array =
+      Array::create(ConstantExpr::create(size, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::constant(Contents.clone()));
+  const Array *values =
+      Array::create(ConstantExpr::create(size, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::makeSymbolic("arr", 6));
+
+  // Rewriting the same few indices keeps the list short, and constant
+  // values end up in the root array
+  ref<Expr> symbolicIndex = ReadExpr::createTempRead(values, Expr::Int32);
+  UpdateList ul(array, 0);
+  ul.extend(symbolicIndex, ConstantExpr::create(7, Expr::Int8));
+  for (unsigned i = 0; i < 4096; ++i)
+    ul.extend(ConstantExpr::create(i % size, Expr::Int32),
+              ConstantExpr::create(i % 251, Expr::Int8));
+  EXPECT_LT(ul.getSize(), 256u);
+
+  for (unsigned i = 0; i < size; ++i) {
+    ref<Expr> read = ReadExpr::create(ul, ConstantExpr::create(i, Expr::Int32));
+    ASSERT_EQ(Expr::Constant, read->getKind());
+    EXPECT_EQ((4096 - size + i) % 251,
+              cast<ConstantExpr>(read)->getZExtValue());
+  }
+
+  // The update at a symbolic index is still there
+  ref<Expr> read = ReadExpr::create(ul, symbolicIndex);
+  ASSERT_EQ(Expr::Read, read->getKind());
+  EXPECT_EQ(array, cast<ReadExpr>(read)->updates.root);
+
+  // Constant values below any update at a symbolic index are folded
+  UpdateList folded(array, 0);
+  for (unsigned i = 0; i < 4096; ++i)
+    folded.extend(ConstantExpr::create(i % size, Expr::Int32),
+                  ConstantExpr::create(i % 251, Expr::Int8));
+  EXPECT_NE(array, folded.root);
+  EXPECT_LT(folded.getSize(), 256u);
+  for (unsigned i = 0; i < size; ++i) {
+    ref<Expr> read =
+        ReadExpr::create(folded, ConstantExpr::create(i, Expr::Int32));
+    ASSERT_EQ(Expr::Constant, read->getKind());
+    EXPECT_EQ((4096 - size + i) % 251,
+              cast<ConstantExpr>(read)->getZExtValue());
+  }
+}
+
+TEST(ExprTest, RewriteEqualitiesIncrementally) {
+  const Array *a =
+      Array::create(ConstantExpr::create(4, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::makeSymbolic("a", 0));
+  const Array *b =
+      Array::create(ConstantExpr::create(4, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::makeSymbolic("b", 0));
+  ref<Expr> a0 = ReadExpr::create(UpdateList(a, 0),
+                                  ConstantExpr::create(0, Expr::Int32));
+  ref<Expr> a1 = ReadExpr::create(UpdateList(a, 0),
+                                  ConstantExpr::create(1, Expr::Int32));
+  ref<Expr> b0 = ReadExpr::create(UpdateList(b, 0),
+                                  ConstantExpr::create(0, Expr::Int32));
+
+  PathConstraints pc;
+  ref<Expr> less = UltExpr::create(a1, a0);
+  ref<Expr> bound = UltExpr::create(b0, ConstantExpr::create(7, Expr::Int8));
+  pc.addConstraint(less);
+  pc.addConstraint(bound);
+  ref<Expr> eq = EqExpr::create(ConstantExpr::create(3, Expr::Int8), a0);
+  pc.addConstraint(eq);
+
+  // Only the constraint sharing an array with the equality is rewritten
+  ref<Expr> rewritten =
+      UltExpr::create(a1, ConstantExpr::create(3, Expr::Int8));
+  const constraints_ty &cs = pc.cs().cs();
+  EXPECT_EQ(3u, cs.size());
+  EXPECT_EQ(1u, cs.count(eq));
+  EXPECT_EQ(1u, cs.count(rewritten));
+  EXPECT_EQ(1u, cs.count(bound));
+  EXPECT_EQ(ExprHashSet({less, eq}), pc.simplificationMap().at(rewritten));
+  EXPECT_EQ(ExprHashSet({bound}), pc.simplificationMap().at(bound));
+  EXPECT_EQ(0u, pc.simplificationMap().count(less));
+
+  // The independent sets are split as before the rewrite
+  std::vector<ref<const IndependentConstraintSet>> factors;
+  pc.cs().getAllDependentConstraintsSets(b0, factors);
+  ASSERT_EQ(1u, factors.size());
+  EXPECT_EQ(1u, factors[0]->exprs.size());
+  factors.clear();
+  pc.cs().getAllDependentConstraintsSets(a1, factors);
+  ASSERT_EQ(1u, factors.size());
+  EXPECT_EQ(2u, factors[0]->exprs.size());
+}
+
+#ifdef KLEE_THREAD_SAFE_EXPR
+TEST(ExprTest, ConcurrentHashConsing) {
+  enableConcurrentRefs();
+  const Array *array =
+      Array::create(ConstantExpr::create(256, sizeof(uint64_t) * CHAR_BIT),
+                    SourceBuilder::makeSymbolic("arr", 3));
+  ref<Expr> read = Expr::createTempRead(array, Expr::Int32);
+  const unsigned threads = 4;
+  const unsigned exprs = 64;
+
+  // Half of the expressions are kept alive, the other half is repeatedly
+  // created and dropped by all threads at once.
+  std::vector<ref<Expr>> kept;
+  for (unsigned i = 0; i < exprs; i += 2)
+    kept.push_back(AddExpr::create(read, ConstantExpr::create(i, Expr::Int32)));
+
+  std::vector<std::vector<ref<Expr>>> built(threads);
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      for (unsigned round = 0; round < 100; ++round) {
+        for (unsigned i = 0; i < exprs; ++i) {
+          ref<Expr> e =
+              AddExpr::create(read, ConstantExpr::create(i, Expr::Int32));
+          if (round == 99 && i % 2 == 0)
+            built[t].push_back(e);
+        }
+      }
+    });
+  }
+  for (auto &worker : workers)
+    worker.join();
+
+  for (unsigned t = 0; t < threads; ++t) {
+    ASSERT_EQ(kept.size(), built[t].size());
+    for (unsigned i = 0; i < kept.size(); ++i)
+      EXPECT_EQ(kept[i].get(), built[t][i].get());
+  }
+}
+#endif
 } // namespace
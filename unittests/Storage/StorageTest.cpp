@@ -31,6 +31,26 @@ TEST(StorageTest, StorageAdapter) {
   ASSERT_EQ(sum, 3);
 }
 
+TEST(StorageTest, MemoryUsage) {
+  std::unique_ptr<StorageAdapter<unsigned char>> uma(
+      new UnorderedMapAdapder<unsigned char>());
+  std::unique_ptr<StorageAdapter<unsigned char>> puma(
+      new PersistenUnorderedMapAdapder<unsigned char>());
+  std::unique_ptr<StorageAdapter<unsigned char>> saa(
+      new SparseArrayAdapter<unsigned char>(0, 12));
+  ASSERT_EQ(puma->getMemoryUsage(), 0u);
+  ASSERT_EQ(saa->getMemoryUsage(), 12u);
+  auto emptyMapUsage = uma->getMemoryUsage();
+  for (size_t i = 0; i < 8; ++i) {
+    uma->set(i, 1);
+    puma->set(i, 1);
+    saa->set(i, 1);
+  }
+  ASSERT_GT(uma->getMemoryUsage(), emptyMapUsage);
+  ASSERT_GT(puma->getMemoryUsage(), 0u);
+  ASSERT_EQ(saa->getMemoryUsage(), 12u);
+}
+
 TEST(StorageTest, FixedSizeStorageAdapter) {
   std::unique_ptr<FixedSizeStorageAdapter<unsigned char>> va(
       new VectorAdapter<unsigned char>(32));
@@ -56,3 +76,60 @@ TEST(StorageTest, FixedSizeStorageAdapter) {
   }
   ASSERT_EQ(sum, 3);
 }
+
+TEST(StorageTest, PagedArrayAdapter) {
+  using adapter_ty = PagedArrayAdapter<unsigned char>;
+  const size_t size = 3 * adapter_ty::PageSize;
+  adapter_ty original(0, size);
+  ASSERT_EQ(original.getMemoryUsage(), 3 * sizeof(std::shared_ptr<void>));
+  original.set(1, 1);
+  original.set(size - 1, 2);
+  ASSERT_EQ(original.size(), 2u);
+
+  adapter_ty copy(original);
+  ASSERT_EQ(copy.sharedPages(), 2u);
+  copy.set(2, 3);
+  copy.remove(size - 1);
+  ASSERT_EQ(copy.sharedPages(), 0u);
+  ASSERT_EQ(copy.size(), 2u);
+  ASSERT_EQ(copy.at(1), 1);
+  ASSERT_EQ(copy.at(2), 3);
+  ASSERT_EQ(copy.lookup(size - 1), nullptr);
+  ASSERT_EQ(original.at(2), 0);
+  ASSERT_EQ(original.at(size - 1), 2);
+
+  size_t sum = 0;
+  for (const auto &val : original) {
+    sum += val.first + val.second;
+  }
+  ASSERT_EQ(sum, 1u + 1u + (size - 1) + 2u);
+}
+
+TEST(StorageTest, DensityAdapter) {
+  using adapter_ty = DensityAdapter<unsigned char>;
+  adapter_ty adapter;
+  adapter.set(1000, 1);
+  ASSERT_EQ(adapter.getDensity(), Density::Sparse);
+  for (size_t i = 0; i < 256; ++i) {
+    adapter.set(i, 2);
+  }
+  ASSERT_EQ(adapter.getDensity(), Density::Dense);
+  ASSERT_EQ(adapter.size(), 257u);
+  ASSERT_EQ(adapter.at(1000), 1);
+  ASSERT_EQ(adapter.lookup(999), nullptr);
+
+  adapter_ty copy(adapter);
+  size_t sum = 0;
+  for (const auto &val : copy) {
+    sum += val.second;
+  }
+  ASSERT_EQ(sum, 1u + 256u * 2u);
+
+  for (size_t i = 0; i < 256; ++i) {
+    adapter.remove(i);
+  }
+  ASSERT_EQ(adapter.getDensity(), Density::Sparse);
+  ASSERT_EQ(adapter.size(), 1u);
+  ASSERT_EQ(adapter.at(1000), 1);
+  ASSERT_EQ(copy.size(), 257u);
+}